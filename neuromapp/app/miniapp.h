@@ -89,6 +89,7 @@ void register_miniapps(mapp::driver &d) {
 #endif
 #if NEUROMAPP_CORENEURON_MAPP
     d.insert("event",event_execute);
+    d.insert("spike_bench",spike_bench_execute);
     d.insert("kernel",coreneuron10_kernel_execute);
     d.insert("solver",coreneuron10_solver_execute);
     d.insert("cstep",coreneuron10_cstep_execute);
@@ -0,0 +1,169 @@
+/*
+ * Neuromapp - bench.cpp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/drivers/bench.cpp
+ * Spike exchange micro benchmark: sweeps the number of ranks
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstdio>
+#include <boost/program_options.hpp>
+#include <stdlib.h>
+
+#include "utils/error.h"
+#include "neuromapp/utils/mpi/mpi_helper.h"
+#include "coreneuron_1.0/event_passing/spike/bench_csv.h"
+
+/** namespace alias for boost::program_options **/
+namespace po = boost::program_options;
+
+/** \fn spike_bench_help(int argc, char *const argv[], po::variables_map& vm)
+    \brief Helper using boost program option to facilitate the command line manipulation
+    \param argc number of argument from the command line
+    \param argv the command line from the driver or external call
+    \param vm encapsulate the command line
+    \return error message from mapp::mapp_error
+ */
+int spike_bench_help(int argc, char* const argv[], po::variables_map& vm){
+    po::options_description desc("Allowed options");
+    desc.add_options()
+    ("help", "produce this help message")
+    ("run", po::value<std::string>()->default_value(launcher_helper::mpi_launcher()),
+    "the command to run parallel jobs")
+    ("ranks", po::value<std::string>()->default_value("2,4,8"),
+    "the numbers of MPI processes, comma separated (oversubscribed on one machine)")
+    ("spikes", po::value<std::string>()->default_value("10,100,1000"),
+    "the numbers of spikes sent per rank and exchange, comma separated")
+    ("exchanges", po::value<std::string>()->default_value("allgather,node,targeted,neighbor"),
+    "the exchange algorithms, comma separated: allgather, node, targeted, neighbor")
+    ("encodings", po::value<std::string>()->default_value("struct,compact"),
+    "the message encodings, comma separated: struct (MPI struct) or compact (allgather and neighbor only)")
+    ("reps", po::value<size_t>()->default_value(100),
+    "the number of measured exchanges per configuration")
+    ("numcells", po::value<size_t>()->default_value(1024),
+    "total number of presynaptic cells (gids)")
+    ("fanin", po::value<size_t>()->default_value(12),
+    "the number of synapses per neuron (targets of the targeted and neighbor exchanges)")
+    ("mindelay", po::value<size_t>()->default_value(5),
+    "the length of the interval of the spike times")
+    ("csv", po::value<std::string>()->default_value("spike_bench.csv"),
+    "the consolidated results, overwritten")
+    ("baseline", po::value<std::string>(),
+    "a csv of a previous sweep, compared with the new one")
+    ("norun", "compare --csv with --baseline, without running");
+
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")){
+        std::cout << desc;
+        return mapp::MAPP_USAGE;
+    }
+
+    if(vm.count("norun") && !vm.count("baseline")){
+	std::cout<<"--norun needs a --baseline"<<std::endl;
+	return mapp::MAPP_BAD_ARG;
+    }
+
+    std::vector<std::string> ranks = bench_split(vm["ranks"].as<std::string>());
+    for(int i = 0; i < ranks.size(); ++i){
+        if(atoi(ranks[i].c_str()) < 1 ||
+           static_cast<size_t>(atoi(ranks[i].c_str())) > vm["numcells"].as<size_t>()){
+	    std::cout<<"must execute on at least 1 process and have at least 1 gid per process"<<std::endl;
+	    return mapp::MAPP_BAD_ARG;
+        }
+    }
+
+    std::vector<std::string> exchanges = bench_split(vm["exchanges"].as<std::string>());
+    for(int i = 0; i < exchanges.size(); ++i){
+        if(exchanges[i] != "allgather" && exchanges[i] != "node" &&
+           exchanges[i] != "targeted" && exchanges[i] != "neighbor"){
+	    std::cout<<"exchanges must be allgather, node, targeted or neighbor"<<std::endl;
+	    return mapp::MAPP_BAD_ARG;
+        }
+    }
+
+    std::vector<std::string> encodings = bench_split(vm["encodings"].as<std::string>());
+    for(int i = 0; i < encodings.size(); ++i){
+        if(encodings[i] != "struct" && encodings[i] != "compact"){
+	    std::cout<<"encodings must be struct or compact"<<std::endl;
+	    return mapp::MAPP_BAD_ARG;
+        }
+    }
+
+    return mapp::MAPP_OK;
+}
+
+/** \fn spike_bench_content(po::variables_map const& vm)
+    \brief runs spike_bench once per number of ranks, every run appends its
+    lines to the csv, then compares the csv with the baseline
+    \param vm encapsulate the command line and all needed informations
+    \return mapp::MAPP_BAD_DATA if a csv can not be read
+ */
+int spike_bench_content(po::variables_map const& vm){
+    std::string csv = vm["csv"].as<std::string>();
+    if(!vm.count("norun")){
+        std::remove(csv.c_str());
+        std::string path = helper_build_path::mpi_bin_path();
+        std::vector<std::string> ranks = bench_split(vm["ranks"].as<std::string>());
+        for(int i = 0; i < ranks.size(); ++i){
+            std::stringstream command;
+            //more ranks than cores on a workstation (Open MPI refuses by default)
+            command << "OMP_NUM_THREADS=1 OMPI_MCA_rmaps_base_oversubscribe=1 " <<
+                vm["run"].as<std::string>() << " -n " << ranks[i] << " " << path <<
+                "spike_bench " << vm["spikes"].as<std::string>() << " " <<
+                vm["exchanges"].as<std::string>() << " " <<
+                vm["encodings"].as<std::string>() << " " <<
+                vm["reps"].as<size_t>() << " " << vm["numcells"].as<size_t>() << " " <<
+                vm["fanin"].as<size_t>() << " " << vm["mindelay"].as<size_t>() << " " << csv;
+            std::cout<< "Running command " << command.str() <<std::endl;
+            system(command.str().c_str());
+        }
+    }
+
+    if(vm.count("baseline")){
+        std::vector<bench_result> current, baseline;
+        if(!read_bench_csv(csv, current) ||
+           !read_bench_csv(vm["baseline"].as<std::string>(), baseline)){
+            std::cout<<"cannot read the csv files"<<std::endl;
+            return mapp::MAPP_BAD_DATA;
+        }
+        if(compare_bench(current, baseline, std::cout) == 0)
+            std::cout<<"no configuration in common with the baseline"<<std::endl;
+    }
+    return mapp::MAPP_OK;
+}
+
+int spike_bench_execute(int argc, char* const argv[]){
+    try {
+        po::variables_map vm; // it contains everything
+        if(int error = spike_bench_help(argc, argv, vm)) return error;
+        return spike_bench_content(vm); // execute the miniapp
+    }
+    catch(std::exception& e){
+        std::cout << e.what() << "\n";
+        return mapp::MAPP_UNKNOWN_ERROR;
+    }
+    return mapp::MAPP_OK; // 0 ok, 1 not ok
+}
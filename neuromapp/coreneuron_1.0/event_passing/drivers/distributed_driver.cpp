@@ -24,6 +24,8 @@
  */
 #include <mpi.h>
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <ctime>
 #include <stdlib.h>
 #include <cassert>
@@ -34,6 +36,7 @@
 #include "coreneuron_1.0/event_passing/queueing/thread.h"
 #include "coreneuron_1.0/event_passing/environment/generator.h"
 #include "coreneuron_1.0/event_passing/environment/event_generators.hpp"
+#include "coreneuron_1.0/event_passing/environment/stream_generator.h"
 #include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
 #include "coreneuron_1.0/event_passing/spike/spike_interface.h"
 #include "coreneuron_1.0/event_passing/spike/algos.hpp"
@@ -44,8 +47,27 @@
 #include "utils/omp/compatibility.h"
 
 
+/** \fn run_sim(G& generator, queueing::pool& pl, ...)
+ *  \brief runs the simulation loop until simtime
+ *  \param generator event_generator or stream_generator
+ */
+template <typename G>
+void run_sim(G& generator, queueing::pool& pl,
+             const environment::presyn_maker& presyns,
+             spike::spike_interface& s_interface, MPI_Datatype mpi_spike,
+             MPI_Comm neighborhood, int simtime, bool compact){
+    while(pl.get_time() <= simtime){
+        pl.fixed_step(generator, presyns);
+        if(compact)
+            compact_distributed_spike(s_interface, neighborhood);
+        else
+            distributed_spike(s_interface, mpi_spike, neighborhood);
+        pl.filter(presyns);
+    }
+}
+
 int main(int argc, char* argv[]) {
-    assert(argc == 8);
+    assert(argc >= 12 && argc <= 14);
 
     MPI_Init(NULL, NULL);
     MPI_Datatype mpi_spike = create_spike_type();
@@ -60,36 +82,60 @@ int main(int argc, char* argv[]) {
     int nSpikes = atoi(argv[5]);
     int mindelay = atoi(argv[6]);
     bool algebra = atoi(argv[7]);
+    bool compact = atoi(argv[8]) == compact_exchange;
+    queueing::nrnthread_source source = atoi(argv[9]) ?
+        queueing::cloned_data : queueing::shared_data;
+    bool stream = atoi(argv[10]);
+    queueing::schedule_mode schedule =
+        static_cast<queueing::schedule_mode>(atoi(argv[11]));
+    //optional trace of the queue operations ("-" for none) and telemetry,
+    //one file per rank
+    std::string trace = argc > 12 && std::string(argv[12]) != "-" ? argv[12] : "";
+    std::string telemetry = argc > 13 ? argv[13] : "";
 
     struct timeval start, end;
 
     int cellsper = ncells / size;
 
     //create environment
-    environment::event_generator generator(ngroups);
-
-    double mean = static_cast<double>(simtime) / static_cast<double>(nSpikes);
-    double lambda = 1.0 / static_cast<double>(mean * size);
-
     environment::continousdistribution neuro_dist(size, rank, ncells);
 
-    environment::generate_events_kai(generator.begin(),
-                              simtime, ngroups, rank, size, lambda, &neuro_dist);
-
     environment::presyn_maker presyns(fanin);
     presyns(rank, &neuro_dist);
     spike::spike_interface s_interface(size);
 
     //run simulation
+    double setup = MPI_Wtime();
     MPI_Comm neighborhood = create_dist_graph(presyns, cellsper);
-    queueing::pool pl(algebra, ngroups, mindelay, rank, s_interface);
-    gettimeofday(&start, NULL);
-    while(pl.get_time() <= simtime){
-        pl.fixed_step(generator, presyns);
-        distributed_spike(s_interface, mpi_spike, neighborhood);
-        pl.filter(presyns);
+    setup = MPI_Wtime() - setup;
+    MPI_Allreduce(MPI_IN_PLACE, &setup, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    if(rank == 0)
+        std::cout<<"graph setup time: "<<1000. * setup<<" ms"<<std::endl;
+    queueing::pool pl(algebra, ngroups, mindelay, rank, s_interface, source, schedule);
+    if(!trace.empty())
+        pl.record_traces();
+    if(!telemetry.empty())
+        pl.record_telemetry();
+    if(stream){
+        //events are drawn on the fly, nSpikes in total on average
+        double rate = static_cast<double>(nSpikes) / (static_cast<double>(simtime) * ncells);
+        environment::stream_generator generator(ngroups, simtime, rate, 12345, neuro_dist);
+        gettimeofday(&start, NULL);
+        run_sim(generator, pl, presyns, s_interface, mpi_spike, neighborhood, simtime, compact);
+        gettimeofday(&end, NULL);
+    }
+    else{
+        environment::event_generator generator(ngroups);
+
+        double mean = static_cast<double>(simtime) / static_cast<double>(nSpikes);
+        double lambda = 1.0 / static_cast<double>(mean * size);
+
+        environment::generate_events_kai(generator.begin(),
+                                  simtime, ngroups, rank, size, lambda, &neuro_dist);
+        gettimeofday(&start, NULL);
+        run_sim(generator, pl, presyns, s_interface, mpi_spike, neighborhood, simtime, compact);
+        gettimeofday(&end, NULL);
     }
-    gettimeofday(&end, NULL);
 
     long long diff_ms = (1000 * (end.tv_sec - start.tv_sec))
         + ((end.tv_usec - start.tv_usec) / 1000);
@@ -101,6 +147,24 @@ int main(int argc, char* argv[]) {
     pl.accumulate_stats();
     accumulate_stats(s_interface);
 
+    if(!trace.empty()){
+        std::stringstream name;
+        name << trace;
+        if(rank > 0)
+            name << "." << rank;
+        if(!pl.write_traces(name.str()))
+            std::cerr<<"cannot write the trace "<<name.str()<<std::endl;
+    }
+
+    if(!telemetry.empty()){
+        std::stringstream name;
+        name << telemetry;
+        if(rank > 0)
+            name << "." << rank;
+        if(!pl.write_telemetry(name.str()))
+            std::cerr<<"cannot write the telemetry "<<name.str()<<std::endl;
+    }
+
     MPI_Comm_free(&neighborhood);
     MPI_Type_free(&mpi_spike);
     MPI_Finalize();
@@ -34,4 +34,12 @@
  */
 int event_execute(int argc, char* const argv[]);
 
+/** \fn spike_bench_execute(int argc, char *const argv[])
+    \brief Spike Exchange Micro Benchmark, sweeps the number of ranks
+    \param argc number of argument from the command line
+    \param argv the command line from the driver or external call
+    \return error message from mapp::mapp_error
+ */
+int spike_bench_execute(int argc, char* const argv[]);
+
 #endif
@@ -24,6 +24,8 @@
  */
 #include <mpi.h>
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <ctime>
 #include <stdlib.h>
 #include <cassert>
@@ -34,18 +36,57 @@
 #include "coreneuron_1.0/event_passing/queueing/thread.h"
 #include "coreneuron_1.0/event_passing/environment/generator.h"
 #include "coreneuron_1.0/event_passing/environment/event_generators.hpp"
+#include "coreneuron_1.0/event_passing/environment/stream_generator.h"
 #include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
 #include "coreneuron_1.0/event_passing/spike/spike_interface.h"
 #include "coreneuron_1.0/event_passing/spike/algos.hpp"
+#include "coreneuron_1.0/event_passing/spike/adaptive.hpp"
 #include "coreneuron_1.0/event_passing/drivers/drivers.h"
 #include "utils/storage/neuromapp_data.h"
 
 // Get OMP header if available
 #include "utils/omp/compatibility.h"
 
+/** \fn run_sim(G& generator, queueing::pool& pl, ...)
+ *  \brief runs the simulation loop until simtime
+ *  \param generator event_generator or stream_generator
+ *  \param c the exchange algorithm and its context
+ */
+template <typename G>
+void run_sim(G& generator, queueing::pool& pl,
+             const environment::presyn_maker& presyns,
+             spike::spike_interface& s_interface, MPI_Datatype mpi_spike,
+             int simtime, exchange_context& c){
+    std::vector<exchange_mode> candidates;
+    if(c.mode_ == auto_exchange){
+        candidates.push_back(allgather_exchange);
+        candidates.push_back(compact_exchange);
+        candidates.push_back(hierarchical_exchange);
+        candidates.push_back(targeted_exchange);
+        candidates.push_back(neighbor_exchange);
+    }
+    exchange_selector selector(candidates);
+    while(pl.get_time() <= simtime){
+        pl.fixed_step(generator, presyns);
+        if(c.mode_ == auto_exchange){
+            //filter is timed too: the compact and hierarchical exchanges
+            //decode the received spikes there
+            double t0 = MPI_Wtime();
+            int nspikes = s_interface.spikeout_.size();
+            exchange_spikes(s_interface, mpi_spike, selector.mode(), c);
+            pl.filter(presyns);
+            selector.record(MPI_Wtime() - t0, nspikes);
+        }
+        else{
+            exchange_spikes(s_interface, mpi_spike, c.mode_, c);
+            pl.filter(presyns);
+        }
+    }
+}
+
 int main(int argc, char* argv[]) {
 
-    assert(argc == 8);
+    assert(argc >= 12 && argc <= 14);
 
     MPI_Init(NULL, NULL);
     MPI_Datatype mpi_spike = create_spike_type();
@@ -60,33 +101,57 @@ int main(int argc, char* argv[]) {
     int nSpikes = atoi(argv[5]);
     int mindelay = atoi(argv[6]);
     bool algebra = atoi(argv[7]);
+    exchange_mode exchange = static_cast<exchange_mode>(atoi(argv[8]));
+    queueing::nrnthread_source source = atoi(argv[9]) ?
+        queueing::cloned_data : queueing::shared_data;
+    bool stream = atoi(argv[10]);
+    queueing::schedule_mode schedule =
+        static_cast<queueing::schedule_mode>(atoi(argv[11]));
+    //optional trace of the queue operations ("-" for none) and telemetry,
+    //one file per rank
+    std::string trace = argc > 12 && std::string(argv[12]) != "-" ? argv[12] : "";
+    std::string telemetry = argc > 13 ? argv[13] : "";
 
     struct timeval start, end;
 
     //create environment
-    environment::event_generator generator(ngroups);
-
-    double mean = static_cast<double>(simtime) / static_cast<double>(nSpikes);
-    double lambda = 1.0 / static_cast<double>(mean * size);
-
     environment::continousdistribution neuro_dist(size, rank, ncells);
 
-    environment::generate_events_kai(generator.begin(),
-                             simtime, ngroups, rank, size, lambda, &neuro_dist);
-
     environment::presyn_maker presyns(fanin);
     presyns(rank, &neuro_dist);
     spike::spike_interface s_interface(size);
     //run simulation
-    queueing::pool pl(algebra, ngroups, mindelay, rank, s_interface);
-    gettimeofday(&start, NULL);
-    int cntr = 0;
-    while(pl.get_time() <= simtime){
-        pl.fixed_step(generator, presyns);
-        blocking_spike(s_interface, mpi_spike);
-        pl.filter(presyns);
+    queueing::pool pl(algebra, ngroups, mindelay, rank, s_interface, source, schedule);
+    if(!trace.empty())
+        pl.record_traces();
+    if(!telemetry.empty())
+        pl.record_telemetry();
+    double setup = MPI_Wtime();
+    exchange_context c = create_exchange_context(exchange, presyns, ncells);
+    setup = MPI_Wtime() - setup;
+    MPI_Allreduce(MPI_IN_PLACE, &setup, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    if(rank == 0)
+        std::cout<<exchange_name(exchange)<<" exchange setup time: "<<1000. * setup<<" ms"<<std::endl;
+    if(stream){
+        //events are drawn on the fly, nSpikes in total on average
+        double rate = static_cast<double>(nSpikes) / (static_cast<double>(simtime) * ncells);
+        environment::stream_generator generator(ngroups, simtime, rate, 12345, neuro_dist);
+        gettimeofday(&start, NULL);
+        run_sim(generator, pl, presyns, s_interface, mpi_spike, simtime, c);
+        gettimeofday(&end, NULL);
+    }
+    else{
+        environment::event_generator generator(ngroups);
+
+        double mean = static_cast<double>(simtime) / static_cast<double>(nSpikes);
+        double lambda = 1.0 / static_cast<double>(mean * size);
+
+        environment::generate_events_kai(generator.begin(),
+                                 simtime, ngroups, rank, size, lambda, &neuro_dist);
+        gettimeofday(&start, NULL);
+        run_sim(generator, pl, presyns, s_interface, mpi_spike, simtime, c);
+        gettimeofday(&end, NULL);
     }
-    gettimeofday(&end, NULL);
 
     long long diff_ms = (1000 * (end.tv_sec - start.tv_sec))
         + ((end.tv_usec - start.tv_usec) / 1000);
@@ -97,6 +162,25 @@ int main(int argc, char* argv[]) {
     pl.accumulate_stats();
     accumulate_stats(s_interface);
 
+    if(!trace.empty()){
+        std::stringstream name;
+        name << trace;
+        if(rank > 0)
+            name << "." << rank;
+        if(!pl.write_traces(name.str()))
+            std::cerr<<"cannot write the trace "<<name.str()<<std::endl;
+    }
+
+    if(!telemetry.empty()){
+        std::stringstream name;
+        name << telemetry;
+        if(rank > 0)
+            name << "." << rank;
+        if(!pl.write_telemetry(name.str()))
+            std::cerr<<"cannot write the telemetry "<<name.str()<<std::endl;
+    }
+
+    free_exchange_context(c);
     MPI_Type_free(&mpi_spike);
     MPI_Finalize();
     return 0;
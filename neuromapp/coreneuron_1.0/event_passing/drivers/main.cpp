@@ -25,11 +25,13 @@
 
 #include <iostream>
 #include <string>
+#include <algorithm>
 #include <sstream>
 #include <boost/program_options.hpp>
 #include <stdlib.h>
 
 #include "utils/error.h"
+#include "coreneuron_1.0/event_passing/queueing/telemetry.h"
 #include "neuromapp/utils/mpi/mpi_helper.h"
 
 /** namespace alias for boost::program_options **/
@@ -65,7 +67,21 @@ int event_help(int argc, char* const argv[], po::variables_map& vm){
     ("mindelay", po::value<size_t>()->default_value(3),
     "the number of timesteps per fixed step function")
     ("distributed", "if set, use distributed graph implementation")
-    ("algebra","If set, perform linear algebra");
+    ("exchange", po::value<std::string>()->default_value("allgather"),
+    "spike exchange: allgather, compact (time offsets + delta gids), node (one allgatherv per node, the ranks of a node share the spikes in MPI shared memory) targeted (alltoallv, a spike goes to the ranks having a target for it only), neighbor (neighbor allgatherv on the distributed graph) or auto (the fastest of them, measured during the run)")
+    ("compact", "same as --exchange compact")
+    ("stream", "if set, draw the spikes on the fly (per neuron Poisson streams) instead of generating them all up front")
+    ("nrnthread", po::value<std::string>()->default_value("clone"),
+    "NrnThread of each cell group: clone (private copy) or shared (same for all)")
+    ("schedule", po::value<std::string>()->default_value("static"),
+    "distribution of the cell groups over the threads: static (round robin), dynamic (first come first served) or tasks (OpenMP tasks)")
+    ("algebra","If set, perform linear algebra")
+    ("trace", po::value<std::string>(),
+    "record the queue operations into this binary file (.rank appended for rank > 0), replayed by the queue miniapp --trace")
+    ("telemetry", po::value<std::string>(),
+    "record the queue depth, inter thread inbox length and delivery time of every cell group per min delay interval into this binary file (.rank appended for rank > 0)")
+    ("summarize", po::value<std::string>(),
+    "print the summary of a telemetry file and exit");
 
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
@@ -85,6 +101,35 @@ int event_help(int argc, char* const argv[], po::variables_map& vm){
 	return mapp::MAPP_BAD_ARG;
     }
 
+    if(vm["nrnthread"].as<std::string>() != "clone" &&
+       vm["nrnthread"].as<std::string>() != "shared"){
+	std::cout<<"nrnthread must be clone or shared"<<std::endl;
+	return mapp::MAPP_BAD_ARG;
+    }
+
+    if(vm["exchange"].as<std::string>() != "allgather" &&
+       vm["exchange"].as<std::string>() != "compact" &&
+       vm["exchange"].as<std::string>() != "node" &&
+       vm["exchange"].as<std::string>() != "targeted" &&
+       vm["exchange"].as<std::string>() != "neighbor" &&
+       vm["exchange"].as<std::string>() != "auto"){
+	std::cout<<"exchange must be allgather, compact, node, targeted, neighbor or auto"<<std::endl;
+	return mapp::MAPP_BAD_ARG;
+    }
+
+    if(vm.count("distributed") && vm["exchange"].as<std::string>() != "allgather" &&
+       vm["exchange"].as<std::string>() != "compact"){
+	std::cout<<"the distributed graph exchanges spikes with neighbor allgather or compact only"<<std::endl;
+	return mapp::MAPP_BAD_ARG;
+    }
+
+    if(vm["schedule"].as<std::string>() != "static" &&
+       vm["schedule"].as<std::string>() != "dynamic" &&
+       vm["schedule"].as<std::string>() != "tasks"){
+	std::cout<<"schedule must be static, dynamic or tasks"<<std::endl;
+	return mapp::MAPP_BAD_ARG;
+    }
+
     if(vm["numcells"].as<size_t>() < vm["numprocs"].as<size_t>()){
 	std::cout<<"must have at least 1 gid per process"<<std::endl;
 	return mapp::MAPP_BAD_ARG;
@@ -114,6 +159,17 @@ void event_content(po::variables_map const& vm){
     size_t mindelay = vm["mindelay"].as<size_t>();
     size_t algebra = vm.count("algebra");
     bool distributed = vm.count("distributed");
+    //exchange_mode
+    std::string exchange_name = vm["exchange"].as<std::string>();
+    const char* exchanges[] = {"allgather", "compact", "node", "targeted", "neighbor", "auto"};
+    size_t exchange = std::find(exchanges, exchanges + 6, exchange_name) - exchanges;
+    if(exchange == 0 && vm.count("compact"))
+        exchange = 1;
+    size_t clone = vm["nrnthread"].as<std::string>() == "clone";
+    size_t stream = vm.count("stream");
+    //queueing::schedule_mode
+    std::string schedule_name = vm["schedule"].as<std::string>();
+    size_t schedule = schedule_name == "dynamic" ? 1 : (schedule_name == "tasks" ? 2 : 0);
 
     std::string exec;
     if(distributed){
@@ -127,16 +183,36 @@ void event_content(po::variables_map const& vm){
         mpi_run <<" -n "<< nproc << " " << path << exec <<
         ngroup << " " << simtime << " " <<
         ncells << " " << fanin << " " <<
-        nspike << " " << mindelay << " " << algebra;
+        nspike << " " << mindelay << " " << algebra << " " << exchange << " " << clone << " " << stream << " " << schedule;
+    if(vm.count("trace") || vm.count("telemetry"))
+        command << " " << (vm.count("trace") ? vm["trace"].as<std::string>() : "-");
+    if(vm.count("telemetry"))
+        command << " " << vm["telemetry"].as<std::string>();
 
     std::cout<< "Running command " << command.str() <<std::endl;
 	system(command.str().c_str());
 }
 
+/** \fn event_summarize(std::string const& name)
+    \brief prints the summary of the telemetry file name
+    \return mapp::MAPP_BAD_DATA if it can not be read
+ */
+int event_summarize(std::string const& name){
+    queueing::telemetry t;
+    if(!t.read(name)){
+        std::cout<<"cannot read the telemetry "<<name<<std::endl;
+        return mapp::MAPP_BAD_DATA;
+    }
+    t.summarize(std::cout);
+    return mapp::MAPP_OK;
+}
+
 int event_execute(int argc, char* const argv[]){
     try {
         po::variables_map vm; // it contains everything
         if(int error = event_help(argc, argv, vm)) return error;
+        if(vm.count("summarize"))
+            return event_summarize(vm["summarize"].as<std::string>());
         event_content(vm); // execute the miniapp
     }
     catch(std::exception& e){
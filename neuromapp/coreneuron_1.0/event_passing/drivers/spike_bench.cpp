@@ -0,0 +1,99 @@
+/*
+ * Neuromapp - spike_bench.cpp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/event_passing/drivers/spike_bench.cpp
+ * measures the spike exchange algorithms on the current number of ranks,
+ * without queueing, and appends the results to the consolidated csv
+ */
+#include <mpi.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <cassert>
+
+#include "coreneuron_1.0/event_passing/environment/neurondistribution.h"
+#include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
+#include "coreneuron_1.0/event_passing/spike/spike_interface.h"
+#include "coreneuron_1.0/event_passing/spike/algos.hpp"
+#include "coreneuron_1.0/event_passing/spike/adaptive.hpp"
+#include "coreneuron_1.0/event_passing/spike/benchmark.hpp"
+
+/** arguments: spikes per rank, exchanges and encodings (comma separated
+ *  lists), repetitions, number of cells, fanin, min delay, csv file */
+int main(int argc, char* argv[]) {
+
+    assert(argc == 9);
+
+    MPI_Init(NULL, NULL);
+    MPI_Datatype mpi_spike = create_spike_type();
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    std::vector<std::string> spikes = bench_split(argv[1]);
+    std::vector<std::string> exchanges = bench_split(argv[2]);
+    std::vector<std::string> encodings = bench_split(argv[3]);
+    int reps = atoi(argv[4]);
+    int ncells = atoi(argv[5]);
+    int fanin = atoi(argv[6]);
+    int mindelay = atoi(argv[7]);
+    std::string csv = argv[8];
+
+    environment::continousdistribution neuro_dist(size, rank, ncells);
+    environment::presyn_maker presyns(fanin);
+    presyns(rank, &neuro_dist);
+    std::vector<int> gids;
+    presyns.output_gids(gids);
+    assert(!gids.empty());
+
+    for(int i = 0; i < exchanges.size(); ++i){
+        exchange_mode mode = allgather_exchange;
+        while(mode < auto_exchange && exchanges[i] != exchange_name(mode))
+            mode = static_cast<exchange_mode>(mode + 1);
+        if(mode == auto_exchange || mode == compact_exchange){
+            if(rank == 0)
+                std::cout<<"skipping exchange "<<exchanges[i]<<std::endl;
+            continue;
+        }
+        exchange_context c = create_exchange_context(mode, presyns, ncells);
+        for(int j = 0; j < encodings.size(); ++j){
+            const bool compact = encodings[j] == "compact";
+            if(!bench_supported(mode, compact))
+                continue;
+            for(int k = 0; k < spikes.size(); ++k){
+                spike::spike_interface s_interface(size);
+                bench_result r = run_bench(s_interface, mpi_spike, gids, mode, compact,
+                    atoi(spikes[k].c_str()), reps, mindelay, c, 12345);
+                if(rank == 0){
+                    std::cout<<bench_csv_line(r)<<std::endl;
+                    if(!append_bench_csv(csv, r))
+                        std::cerr<<"cannot write the csv "<<csv<<std::endl;
+                }
+            }
+        }
+        free_exchange_context(c);
+    }
+
+    MPI_Type_free(&mpi_spike);
+    MPI_Finalize();
+    return 0;
+}
@@ -81,6 +81,19 @@ namespace environment
             return start + loc;
         }
 
+        /**
+         *  Group owning the element i of n elements distributed over groups
+         *  as by the constructors: the first n % groups groups have one
+         *  element more
+         */
+        static inline size_t owner(size_t i, size_t groups, size_t n)
+        {
+            const size_t base = n / groups;
+            const size_t extra = n % groups;
+            const size_t large = extra * (base + 1);
+            return i < large ? i / (base + 1) : extra + (i - large) / base;
+        }
+
     private:
         const size_t global_number;
         size_t local_number;
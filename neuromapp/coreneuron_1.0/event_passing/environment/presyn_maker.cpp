@@ -13,10 +13,12 @@
 namespace environment {
 
 void presyn_maker::operator()(int rank, neurondistribution* neuron_dist){
+    std::map<int, std::vector<int> > inputs;
+    std::map<int, std::vector<int> > outputs;
     //create local presyns with empty vectors
     for(int i = 0; i < neuron_dist->getlocalcells(); ++i){
         const int gid = neuron_dist->local2global(i);
-        outputs_[gid];
+        outputs[gid];
     }
 
     if (degree_==fixedindegree) {
@@ -32,13 +34,13 @@ void presyn_maker::operator()(int rank, neurondistribution* neuron_dist){
                 if(neuron_dist->isLocal(cur)){
                     //add self to src gid
                     const int g_i = neuron_dist->local2global(i);
-                    outputs_[cur].push_back(g_i);
+                    outputs[cur].push_back(g_i);
                 }
                 //remote GID
                 else{
                     //add self to input presyn for gid
                     const int g_i = neuron_dist->local2global(i);
-                    inputs_[cur].push_back(g_i);
+                    inputs[cur].push_back(g_i);
                 }
             }
         }
@@ -57,37 +59,25 @@ void presyn_maker::operator()(int rank, neurondistribution* neuron_dist){
                 if(neuron_dist->isLocal(picked)) {
                     if(neuron_dist->isLocal(cur)){
                         //add self to src gid
-                        outputs_[cur].push_back(picked);
+                        outputs[cur].push_back(picked);
                     }
                     //remote GID
                     else{
                         //add self to input presyn for gid
-                        inputs_[cur].push_back(picked);
+                        inputs[cur].push_back(picked);
                     }
                 }
             }
         }
     }
+    //flatten into the lookup tables, the maps are released on return
+    freeze(inputs, outputs);
 }
 
-const presyn* presyn_maker::find_input(int key) const{
-    std::map<int, std::vector<int> >::const_iterator it = inputs_.begin();
-    const presyn* input_ptr = NULL;
-    it = inputs_.find(key);
-    if(it != inputs_.end()){
-        input_ptr = &(it->second);
-    }
-    return input_ptr;
-}
-
-const presyn* presyn_maker::find_output(int key) const{
-    std::map<int, std::vector<int> >::const_iterator it = outputs_.begin();
-    const presyn* output_ptr = NULL;
-    it = outputs_.find(key);
-    if(it != outputs_.end()){
-        output_ptr = &(it->second);
-    }
-    return output_ptr;
+void presyn_maker::freeze(const std::map<int, std::vector<int> >& inputs,
+                          const std::map<int, std::vector<int> >& outputs){
+    inputs_.build(inputs);
+    outputs_.build(outputs);
 }
 
 } //end of namespace
@@ -30,20 +30,22 @@
 
 #include "coreneuron_1.0/event_passing/environment/generator.h"
 #include "coreneuron_1.0/event_passing/environment/neurondistribution.h"
+#include "coreneuron_1.0/event_passing/environment/presyn_table.h"
 
 namespace environment {
 
-typedef std::vector<int> presyn;
 enum degree {fixedindegree, fixedoutdegree};
 /** presyn_maker
- * creates input and output presyns required for spike exchange
+ * creates input and output presyns required for spike exchange.
+ * The presyns are gathered in maps during construction, then frozen
+ * into flat presyn_tables (CSR) used by the lookups.
  */
 class presyn_maker {
 private:
     int fan_;
     degree degree_;
-    std::map<int, presyn> inputs_;
-    std::map<int, presyn> outputs_;
+    presyn_table inputs_;
+    presyn_table outputs_;
 public:
     /** \fn presyn_maker(int ncells, int fanin)
      *  \brief creates the presyn_maker and sets member variables
@@ -61,6 +63,14 @@ public:
      */
     void operator()(int rank, neurondistribution* neuron_dist);
 
+    /** \fn void freeze(const std::map<int, std::vector<int> >& inputs,
+     *  const std::map<int, std::vector<int> >& outputs)
+     *  \brief builds the lookup tables from input and output presyns
+     *  given as gid -> destinations maps (called at the end of operator())
+     */
+    void freeze(const std::map<int, std::vector<int> >& inputs,
+                const std::map<int, std::vector<int> >& outputs);
+
 //GETTERS
 
     /** \fn find_input(int id, presyn& ps)
@@ -71,7 +81,7 @@ public:
      *  only valid if find_input returns true.
      *  \return true if matching presyn is found, else false
      */
-    const presyn* find_input(int key) const;
+    inline const presyn* find_input(int key) const { return inputs_.find(key); }
 
     /** \fn find_output(int key, presyn& ps)
      *  \brief searches for an out presyn(OP) matching the parameter key. If
@@ -81,7 +91,22 @@ public:
      *  only valid if find_output returns true.
      *  \return true if matching presyn is found, else false
      */
-    const presyn* find_output(int key) const;
+    inline const presyn* find_output(int key) const { return outputs_.find(key); }
+
+    /** \fn input_gids(std::vector<int>& gids)
+     *  \brief the remote gids having an input presyn, in increasing order
+     */
+    inline void input_gids(std::vector<int>& gids) const { inputs_.keys(gids); }
+
+    /** \fn output_gids(std::vector<int>& gids)
+     *  \brief the local gids (output presyns), in increasing order
+     */
+    inline void output_gids(std::vector<int>& gids) const { outputs_.keys(gids); }
+
+    /** \fn memory()
+     *  \return the number of bytes used by the input and output presyns
+     */
+    std::size_t memory() const { return inputs_.memory() + outputs_.memory(); }
 };
 
 } //end of namespace
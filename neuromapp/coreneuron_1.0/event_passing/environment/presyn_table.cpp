@@ -0,0 +1,126 @@
+/*
+ * Neuromapp - presyn_table.cpp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/environment/presyn_table.cpp
+ * \brief Contains presyn_table class definition.
+ */
+
+#include "coreneuron_1.0/event_passing/environment/presyn_table.h"
+
+namespace environment {
+
+presyn_table::presyn_table(const presyn_table& other){
+    *this = other;
+}
+
+presyn_table& presyn_table::operator=(const presyn_table& other){
+    if(this == &other)
+        return *this;
+    dense_ = other.dense_;
+    min_key_ = other.min_key_;
+    mask_ = other.mask_;
+    values_ = other.values_;
+    index_ = other.index_;
+    keys_ = other.keys_;
+    rows_.clear();
+    rows_.reserve(other.rows_.size());
+    const int* base = other.values_.empty() ? NULL : &other.values_[0];
+    const int* mine = values_.empty() ? NULL : &values_[0];
+    for(std::size_t i = 0; i < other.rows_.size(); ++i){
+        const presyn& r = other.rows_[i];
+        rows_.push_back(presyn(r.empty() ? mine : mine + (r.begin() - base), r.size()));
+    }
+    return *this;
+}
+
+void presyn_table::build(const std::map<int, std::vector<int> >& m){
+    values_.clear();
+    rows_.clear();
+    index_.clear();
+    keys_.clear();
+    if(m.empty())
+        return;
+
+    std::size_t nvalues = 0;
+    std::map<int, std::vector<int> >::const_iterator it;
+    for(it = m.begin(); it != m.end(); ++it)
+        nvalues += it->second.size();
+
+    //flatten the destinations, values_ must not reallocate once
+    //the rows point into it
+    values_.reserve(nvalues);
+    rows_.reserve(m.size());
+    for(it = m.begin(); it != m.end(); ++it){
+        const int* first = values_.empty() ? NULL : &values_[0] + values_.size();
+        values_.insert(values_.end(), it->second.begin(), it->second.end());
+        if(first == NULL && !values_.empty())
+            first = &values_[0];
+        rows_.push_back(presyn(first, it->second.size()));
+    }
+
+    //keys are sorted, direct indexing if they fill at least a quarter
+    //of their range (contiguous or round robin distributions)
+    min_key_ = m.begin()->first;
+    const long range = static_cast<long>(m.rbegin()->first) - min_key_ + 1;
+    dense_ = range <= 4 * static_cast<long>(m.size());
+
+    int row = 0;
+    if(dense_){
+        index_.assign(range, -1);
+        for(it = m.begin(); it != m.end(); ++it, ++row)
+            index_[it->first - min_key_] = row;
+        return;
+    }
+
+    //open addressing, load factor <= 0.5
+    unsigned int capacity = 1;
+    while(capacity < 2 * m.size())
+        capacity <<= 1;
+    mask_ = capacity - 1;
+    index_.assign(capacity, -1);
+    keys_.assign(capacity, 0);
+    for(it = m.begin(); it != m.end(); ++it, ++row){
+        unsigned int slot = hash(it->first) & mask_;
+        while(index_[slot] >= 0)
+            slot = (slot + 1) & mask_;
+        index_[slot] = row;
+        keys_[slot] = it->first;
+    }
+}
+
+void presyn_table::keys(std::vector<int>& k) const{
+    k.resize(rows_.size());
+    //rows_ are in key order
+    for(std::size_t i = 0; i < index_.size(); ++i){
+        if(index_[i] >= 0)
+            k[index_[i]] = dense_ ? min_key_ + static_cast<int>(i) : keys_[i];
+    }
+}
+
+std::size_t presyn_table::memory() const{
+    return sizeof(*this)
+        + values_.capacity() * sizeof(int)
+        + rows_.capacity() * sizeof(presyn)
+        + index_.capacity() * sizeof(int)
+        + keys_.capacity() * sizeof(int);
+}
+
+} //end of namespace
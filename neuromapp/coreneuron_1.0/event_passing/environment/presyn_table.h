@@ -0,0 +1,143 @@
+/*
+ * Neuromapp - presyn_table.h, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/environment/presyn_table.h
+ * \brief Contains the presyn and presyn_table class declarations.
+ */
+
+#ifndef MAPP_PRESYN_TABLE_H
+#define MAPP_PRESYN_TABLE_H
+
+#include <map>
+#include <vector>
+#include <cstddef>
+
+namespace environment {
+
+/** presyn
+ * read-only view on the destination gids of one source gid,
+ * a row of a presyn_table
+ */
+class presyn {
+public:
+    typedef const int* const_iterator;
+
+    presyn(): first_(NULL), size_(0){}
+    presyn(const int* first, std::size_t n): first_(first), size_(n){}
+
+    /** \fn size()
+     *  \return the number of destinations
+     */
+    inline std::size_t size() const { return size_; }
+
+    /** \fn empty()
+     *  \return true if there is no destination
+     */
+    inline bool empty() const { return size_ == 0; }
+
+    inline const int& operator[](std::size_t i) const { return first_[i]; }
+    inline const_iterator begin() const { return first_; }
+    inline const_iterator end() const { return first_ + size_; }
+
+private:
+    const int* first_;
+    std::size_t size_;
+};
+
+/** presyn_table
+ * compressed sparse row storage of the presyns: all destinations are
+ * stored contiguously and rows_ holds one view per source gid.
+ *
+ * gids are mapped to rows either by a direct index (offset by the
+ * smallest gid) when the keys are dense enough, or by an open addressing
+ * hash table with linear probing for sparse keys (e.g. the input gids
+ * of remote cells).
+ */
+class presyn_table {
+public:
+    presyn_table(): dense_(true), min_key_(0), mask_(0){}
+
+    /** rows_ point into values_, a copy rebases them on its own values_ */
+    presyn_table(const presyn_table& other);
+    presyn_table& operator=(const presyn_table& other);
+
+    /** \fn void build(const std::map<int, std::vector<int> >& m)
+     *  \brief builds the table from the map used during construction
+     *  \param m the source gid -> destinations map
+     */
+    void build(const std::map<int, std::vector<int> >& m);
+
+    /** \fn find(int key)
+     *  \param key the source gid
+     *  \return the presyn matching key, NULL if none
+     */
+    inline const presyn* find(int key) const{
+        if(rows_.empty())
+            return NULL;
+        if(dense_){
+            const unsigned int i = static_cast<unsigned int>(key - min_key_);
+            if(i >= index_.size() || index_[i] < 0)
+                return NULL;
+            return &rows_[index_[i]];
+        }
+        unsigned int slot = hash(key) & mask_;
+        while(index_[slot] >= 0){
+            if(keys_[slot] == key)
+                return &rows_[index_[slot]];
+            slot = (slot + 1) & mask_;
+        }
+        return NULL;
+    }
+
+    /** \fn size()
+     *  \return the number of source gids stored
+     */
+    inline std::size_t size() const { return rows_.size(); }
+
+    /** \fn void keys(std::vector<int>& k)
+     *  \brief the source gids stored, in increasing order
+     *  \param k receives the keys (previous content discarded)
+     */
+    void keys(std::vector<int>& k) const;
+
+    /** \fn memory()
+     *  \return the number of bytes used by the table
+     */
+    std::size_t memory() const;
+
+private:
+    static inline unsigned int hash(int key){
+        //Knuth multiplicative hash
+        return static_cast<unsigned int>(key) * 2654435761u;
+    }
+
+    bool dense_;
+    int min_key_;
+    unsigned int mask_;
+    std::vector<int> values_;
+    std::vector<presyn> rows_;
+    std::vector<int> index_;
+    std::vector<int> keys_;
+};
+
+} //end of namespace
+
+#endif
@@ -0,0 +1,71 @@
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "coreneuron_1.0/event_passing/environment/stream_generator.h"
+
+namespace environment {
+
+/** \fn unsigned long long mix(unsigned long long x)
+ *  \brief splitmix64 finalizer, a cheap stateless random bit mixer
+ */
+static inline unsigned long long mix(unsigned long long x){
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+stream_generator::stream_generator(int ngroups, int simtime, double rate,
+                                   unsigned int seed,
+                                   const neurondistribution& neuron_dist):
+heaps_(ngroups), rate_(rate), simtime_(simtime), seed_(seed){
+    assert(rate > 0.);
+    for(size_t lid = 0; lid < neuron_dist.getlocalcells(); ++lid){
+        stream s;
+        s.gid_ = neuron_dist.local2global(lid);
+        s.k_ = 0;
+        s.t_ = interval(s.gid_, s.k_++);
+        if(s.t_ < simtime_)
+            heaps_[s.gid_ % ngroups].push_back(s);
+    }
+    for(int i = 0; i < ngroups; ++i)
+        std::make_heap(heaps_[i].begin(), heaps_[i].end(), later);
+}
+
+double stream_generator::interval(int gid, unsigned int k) const{
+    const unsigned long long key = (static_cast<unsigned long long>(seed_) << 32)
+        ^ (static_cast<unsigned long long>(gid) << 20) ^ k;
+    //53 random bits -> uniform in (0,1]
+    const double u = (static_cast<double>(mix(mix(key) ^ gid) >> 11) + 1.)
+        * (1. / 9007199254740992.);
+    return -std::log(u) / rate_;
+}
+
+bool stream_generator::empty(int id) const{
+    return heaps_[id].empty();
+}
+
+bool stream_generator::compare_top_lte(int id, double comparator) const{
+    if(this->empty(id))
+        return false;
+    else
+        return (static_cast<int>(heaps_[id].front().t_) <= comparator);
+}
+
+gen_event stream_generator::pop(int id){
+    std::vector<stream>& heap = heaps_[id];
+    std::pop_heap(heap.begin(), heap.end(), later);
+    stream& s = heap.back();
+    const gen_event ev(s.gid_, static_cast<int>(s.t_));
+
+    //draw the next spike of this neuron, drop it past simtime
+    s.t_ += interval(s.gid_, s.k_++);
+    if(s.t_ < simtime_)
+        std::push_heap(heap.begin(), heap.end(), later);
+    else
+        heap.pop_back();
+    return ev;
+}
+
+} //end of namespace
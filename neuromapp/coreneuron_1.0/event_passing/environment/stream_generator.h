@@ -0,0 +1,93 @@
+#ifndef MAPP_STREAM_GENERATOR_H
+#define MAPP_STREAM_GENERATOR_H
+
+#include <vector>
+
+#include "coreneuron_1.0/event_passing/environment/generator.h"
+#include "coreneuron_1.0/event_passing/environment/neurondistribution.h"
+
+namespace environment {
+
+/** stream_generator
+ *  /brief lazy counterpart of event_generator: instead of storing all
+ *  the events of the simulation, every local neuron is a Poisson stream
+ *  and only its next spike is kept. The streams of a cell group are
+ *  merged by a heap, so the memory is O(local cells) whatever simtime.
+ *
+ *  The k-th inter-spike interval of a neuron is drawn from a counter
+ *  based hash of (seed, gid, k): the spike train of a gid is the same
+ *  whatever the number of ranks or cell groups. Spike times are
+ *  truncated to the timestep, as with the generate_* functions.
+ *
+ *  Offers the compare_top_lte/pop/empty interface of event_generator.
+ */
+class stream_generator {
+private:
+    /// next spike of a neuron
+    struct stream {
+        double t_;      // continuous time of the next spike
+        int gid_;
+        unsigned int k_; // number of spikes drawn so far
+    };
+
+    /// min-heap order on the next spike time, then gid
+    static bool later(const stream& a, const stream& b){
+        return a.t_ > b.t_ || (a.t_ == b.t_ && a.gid_ > b.gid_);
+    }
+
+    std::vector<std::vector<stream> > heaps_;
+    double rate_;
+    int simtime_;
+    unsigned int seed_;
+
+    /** \fn double interval(int gid, unsigned int k) const
+     *  \return the k-th exponential inter-spike interval of gid
+     */
+    double interval(int gid, unsigned int k) const;
+
+public:
+    /** \fn stream_generator(int ngroups, int simtime, double rate,
+     *      unsigned int seed, const neurondistribution& neuron_dist)
+     *  \brief creates one stream per local neuron, neuron gid belongs to the
+     *  cell group gid % ngroups
+     *  \param ngroups the number of cell groups
+     *  \param simtime no event is generated at or after simtime
+     *  \param rate the firing rate of a neuron (in events/timestep)
+     *  \param seed the seed shared by all the ranks
+     *  \param neuron_dist the distribution of the neurons on the ranks
+     */
+    stream_generator(int ngroups, int simtime, double rate, unsigned int seed,
+                     const neurondistribution& neuron_dist);
+
+    /** \fn gen_event pop()(int id)
+     *  \brief retrieves the next event of the specified cell group and
+     *  draws the following spike of its neuron
+     *  \param id specifies which cell group to pop from
+     *  \return the next event
+     */
+    gen_event pop(int id);
+
+//GETTERS
+    /** \fn compare_top_lte(int id, double comparator)
+     *  \brief compares the next event of the ith cell group against the comparator.
+     *  \param id (cell group ID) determines which group
+     *  \return true if top <= comparator. Else false
+     */
+    bool compare_top_lte(int id, double comparator) const;
+
+    /** \fn empty(int id)
+     *  \param id (cell group ID) determines which group
+     *  \return true if the group has no more event before simtime
+     */
+    bool empty(int id) const;
+
+    /** \fn get_nstreams(int id)
+     *  \param id (cell group ID) determines which group
+     *  \return the number of neurons still firing before simtime
+     */
+    int get_nstreams(int id) const { return heaps_[id].size(); }
+};
+
+}// end of namespace
+
+#endif
@@ -37,6 +37,22 @@
 
 namespace queueing {
 
+/** how fixed_step distributes the cell groups over the threads, the work
+ *  unit is a cell group for a whole min delay interval:
+ *  - static_schedule: round robin, schedule(static,1)
+ *  - dynamic_schedule: first come first served, schedule(dynamic,1)
+ *  - task_schedule: one OpenMP task per cell group, the idle threads
+ *  steal the pending tasks
+ */
+enum schedule_mode {static_schedule, dynamic_schedule, task_schedule};
+
+/** load of the threads during one min delay interval */
+struct interval_load {
+    double wall_;      // time of the interval (parallel region)
+    double max_busy_;  // time spent in cell groups by the busiest thread
+    double mean_busy_; // mean over the threads of the time spent in cell groups
+};
+
 class pool {
 private:
     bool perform_algebra_;
@@ -45,21 +61,52 @@ private:
     int rank_;
     spike::spike_interface& spike_;
     std::vector<nrn_thread_data> thread_datas_;
+    schedule_mode schedule_;
+    /// time spent in cell groups by every thread, current interval
+    std::vector<double> busy_;
+    /// one entry per min delay interval
+    std::vector<interval_load> loads_;
+    /// operations of the queue of every cell group, if recorded
+    std::vector< ::queue::trace> traces_;
+    /// queue depth, inbox length and delivery time per interval, if recorded
+    telemetry telemetry_;
 
 public:
 
     /** \fn pool(bool algebra, int ngroups, int min_delay, int rank,
-     * spike_interface& s_interface)
+     * spike_interface& s_interface, nrnthread_source source)
      *  \brief initializes a pool with a thread_datas_ array of size ngroups.
      *  \param algebra determines whether to perform linear algebra calculations
      *  \param ngroups the number of cell groups per node
      *  \param s_interface the spike interface used to communicate
      *  with the spike exchange algos
+     *  \param source cloned_data gives every cell group its own NrnThread,
+     *  cloned by the thread running it in fixed_step (first touch),
+     *  shared_data makes all of them use the NrnThread of the storage
+     *  \param schedule how fixed_step distributes the cell groups over
+     *  the threads
      */
     pool(bool algebra, int ngroups, int md, int rank,
-    spike::spike_interface& s_interface): perform_algebra_(algebra),
-    min_delay_(md), time_(0), rank_(rank), spike_(s_interface)
-    {thread_datas_.resize(ngroups);}
+    spike::spike_interface& s_interface, nrnthread_source source = cloned_data,
+    schedule_mode schedule = static_schedule):
+    perform_algebra_(algebra), min_delay_(md), time_(0), rank_(rank),
+    spike_(s_interface), schedule_(schedule){
+        thread_datas_.resize(ngroups);
+        if(source == cloned_data){
+            //same distribution as the static schedule of fixed_step
+            #pragma omp parallel for schedule(static,1)
+            for(int i = 0; i < thread_datas_.size(); ++i)
+                thread_datas_[i].clone_nrnthread();
+        }
+    }
+
+    /** \fn ~pool()
+     *  \brief frees the cloned NrnThreads
+     */
+    ~pool(){
+        for(int i = 0; i < thread_datas_.size(); ++i)
+            thread_datas_[i].release_nrnthread();
+    }
 
     /** \fn send_events(const int myID, G& generator, const P& presyns)
      *  \brief sends event to it's destination
@@ -71,6 +118,13 @@ public:
     template <typename G, typename P>
     void send_events(const int myID, G& generator, const P& presyns);
 
+    /** \fn double group_interval(int i, G& generator, const P& presyns)
+     *  \brief runs min_delay_ steps of the cell group i
+     *  \return the time spent
+     */
+    template <typename G, typename P>
+    double group_interval(int i, G& generator, const P& presyns);
+
     /** \fn void fixed_step(G& generator, P& presyns)
      *  \brief performs (min_delay_) iterations of a timestep in which:
      *      - events are sent
@@ -82,6 +136,8 @@ public:
      *  \param presyns contains the presyn information used to distribute
      *  events to cellgroups on the same rank.
      *  \precond presyns has been initialized
+     *  The cell groups are distributed over the threads following schedule_,
+     *  the load of the threads is appended to loads_.
      */
     template <typename G, typename P>
     void fixed_step(G& generator, const P& presyns);
@@ -89,13 +145,25 @@ public:
     /** \fn void filter(const P& presyns)
      *  \brief filters out relevent events(using the function matches()),
      *  and randomly selects a destination cellgroup, and delivers them
-     *  using a no-lock inter_thread_send
+     *  using a no-lock inter_thread_send. Spikes received with the compact
+     *  encoding (bytesin_) are decoded here, the ones of the node level
+     *  exchange are read in the shared window (spikein_shared_).
      *  \param presyns the presyn maker from which input presyn information
      *  is taken (used to distribute spike events between cell groups).
      */
     template <typename P>
     void filter(const P& presyns);
 
+    /** \fn void deliver_spike(const P& presyns, const event& e)
+     *  \brief delivers a received spike to the cellgroups having
+     *  an input presyn for its gid
+     *  \param presyns the presyn maker from which input presyn information
+     *  is taken
+     *  \param e the received spike
+     */
+    template <typename P>
+    void deliver_spike(const P& presyns, const event& e);
+
 
     /** \fn accumulate_stats()
      *  \brief accumulate statistics from the threadData array and store
@@ -103,12 +171,53 @@ public:
      */
     void accumulate_stats();
 
+    /** \fn const std::vector<interval_load>& loads()
+     *  \return the load of the threads for every min delay interval
+     */
+    const std::vector<interval_load>& loads() const { return loads_; }
+
+    /** \fn void record_traces()
+     *  \brief records from now on the insert/atomic_dq calls of the queue of
+     *  every cell group
+     */
+    void record_traces();
+
+    /** \fn bool write_traces(std::string const& name)
+     *  \brief writes the recorded traces into the binary file name, to be
+     *  replayed by the queue miniapp (--trace name)
+     *  \return false if the file can not be written
+     */
+    bool write_traces(std::string const& name) const;
+
+    /** \fn void record_telemetry()
+     *  \brief records from now on a telemetry sample of every cell group
+     *  for every min delay interval
+     */
+    void record_telemetry();
+
+    /** \fn bool write_telemetry(std::string const& name)
+     *  \brief writes the recorded samples into the binary file name, to be
+     *  summarized by the event miniapp (--summarize name)
+     *  \return false if the file can not be written
+     */
+    bool write_telemetry(std::string const& name) const;
+
+    /** \fn const telemetry& get_telemetry()
+     *  \return the recorded samples
+     */
+    inline const telemetry& get_telemetry() const { return telemetry_; }
+
 //GETTERS
     /** \fn get_ngroups()
      *  \return the number of cellgroups
      */
     inline int get_ngroups() const { return thread_datas_.size(); }
 
+    /** \fn nrnthread(int i)
+     * \return the NrnThread used by the cell group i
+     */
+    inline const NrnThread* nrnthread(int i) const { return thread_datas_[i].nrnthread(); }
+
     /** \fn get_time()
      * \return the current time_ value for this pool
      */
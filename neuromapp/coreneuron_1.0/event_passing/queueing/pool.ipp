@@ -29,6 +29,7 @@
 #include <fstream>
 #include <time.h>
 #include <ctime>
+#include <algorithm>
 
 #ifndef MAPP_POOL_IPP_
 #define MAPP_POOL_IPP_
@@ -76,68 +77,194 @@ void pool::send_events(const int myID, G& generator, const P& presyns){
 
 //PARALLEL FUNCTIONS
 template <typename G, typename P>
-void pool::fixed_step(G& generator, const P& presyns){
-    #pragma omp parallel for schedule(static,1)
-    for(int i = 0; i < thread_datas_.size(); ++i){
-        for(int j = 0; j < min_delay_; ++j){
-            send_events(i, generator, presyns);
-            //Have threads enqueue their interThreadEvents
-            thread_datas_[i].enqueue_my_events();
+double pool::group_interval(int i, G& generator, const P& presyns){
+    double start = omp_get_wtime();
+    const int delivered = thread_datas_[i].delivered_;
+    const double deliver_time = thread_datas_[i].deliver_time_;
+    int inbox = 0;
+    for(int j = 0; j < min_delay_; ++j){
+        send_events(i, generator, presyns);
+        //Have threads enqueue their interThreadEvents
+        inbox = std::max(inbox, thread_datas_[i].enqueue_my_events());
 
-            if(perform_algebra_)
-                thread_datas_[i].l_algebra();
+        if(perform_algebra_)
+            thread_datas_[i].l_algebra();
 
-            /// Deliver events
-            while(thread_datas_[i].deliver());
+        /// Deliver events
+        thread_datas_[i].deliver_all();
 
-            thread_datas_[i].increment_time();
-        }
+        thread_datas_[i].increment_time();
+    }
+    if(telemetry_.enabled()){
+        telemetry_sample& s = telemetry_.current(i);
+        s.queue_depth_ = thread_datas_[i].pq_size();
+        s.inbox_ = inbox;
+        s.delivered_ = thread_datas_[i].delivered_ - delivered;
+        s.deliver_us_ = 1e6 * (thread_datas_[i].deliver_time_ - deliver_time);
+    }
+    return omp_get_wtime() - start;
+}
+
+template <typename G, typename P>
+void pool::fixed_step(G& generator, const P& presyns){
+    const int ngroups = thread_datas_.size();
+    busy_.assign(omp_get_max_threads(), 0.);
+    double start = omp_get_wtime();
+    switch(schedule_){
+        case dynamic_schedule:
+            #pragma omp parallel for schedule(dynamic,1)
+            for(int i = 0; i < ngroups; ++i)
+                busy_[omp_get_thread_num()] += group_interval(i, generator, presyns);
+            break;
+        case task_schedule:
+            #pragma omp parallel
+            {
+                #pragma omp single nowait
+                {
+                    for(int i = 0; i < ngroups; ++i){
+                        #pragma omp task firstprivate(i) shared(generator, presyns)
+                        busy_[omp_get_thread_num()] += group_interval(i, generator, presyns);
+                    }
+                }
+            }
+            break;
+        default:
+            #pragma omp parallel for schedule(static,1)
+            for(int i = 0; i < ngroups; ++i)
+                busy_[omp_get_thread_num()] += group_interval(i, generator, presyns);
     }
+
+    interval_load load;
+    load.wall_ = omp_get_wtime() - start;
+    load.max_busy_ = 0.;
+    load.mean_busy_ = 0.;
+    for(int i = 0; i < busy_.size(); ++i){
+        load.max_busy_ = std::max(load.max_busy_, busy_[i]);
+        load.mean_busy_ += busy_[i];
+    }
+    load.mean_busy_ /= busy_.size();
+    loads_.push_back(load);
+    if(telemetry_.enabled())
+        telemetry_.end_interval();
+
     time_ += min_delay_;
 }
 
 template <typename P>
-void pool::filter(const P& presyns){
-    double tt;
+void pool::deliver_spike(const P& presyns, const event& e){
     const environment::presyn* input = NULL;
-    int spike_gid;
     int dest;
+    try{
+        if((input = presyns.find_input(e.data_)) != NULL){
+            for(size_t j = 0; j < input->size(); ++j){
+                dest = (*input)[j] % thread_datas_.size();
+                //send using non-mutex inter-thread send here
+                thread_datas_[dest].inter_send_no_lock(dest, e.t_);
+                ++(spike_.post_spike_stats_);
+            }
+        }
+    }
+    catch(const std::bad_alloc&) {
+        std::cout<<"Rank: "<<rank_<<" failed receiving: "<<e.data_<<std::endl;
+        throw;
+    }
+}
+
+template <typename P>
+void pool::filter(const P& presyns){
+    event e;
     try{
         spike_.received_spike_stats_ += spike_.spikein_.size();
         for(int i = 0; i < spike_.spikein_.size(); ++i){
-            tt = spike_.spikein_[i].t_;
-            spike_gid = spike_.spikein_[i].data_;
-            if((input = presyns.find_input(spike_gid)) != NULL){
-                for(size_t j = 0; j < input->size(); ++j){
-                    dest = (*input)[j] % thread_datas_.size();
-                    //send using non-mutex inter-thread send here
-                    thread_datas_[dest].inter_send_no_lock(dest, tt);
-                    ++(spike_.post_spike_stats_);
-                }
+            deliver_spike(presyns, spike_.spikein_[i]);
+        }
+        //spikes read in place from the shared window of the node
+        spike_.received_spike_stats_ += spike_.nshared_;
+        for(int i = 0; i < spike_.nshared_; ++i){
+            deliver_spike(presyns, spike_.spikein_shared_[i]);
+        }
+        //spikes exchanged with the compact encoding
+        if(!spike_.bytesin_.empty()){
+            spike::compact_reader reader(&spike_.bytesin_[0],
+                &spike_.bytesin_[0] + spike_.bytesin_.size(),
+                spike_.codec_.resolution());
+            while(reader.next(e)){
+                ++(spike_.received_spike_stats_);
+                deliver_spike(presyns, e);
             }
         }
     }
     catch(const std::bad_alloc& e) {
-        std::cout<<"Rank: "<<rank_<<" failed receiving: "<<spike_gid<<std::endl;
         std::cout <<"Filter failed: "<<e.what()<<std::endl;
     }
 
     spike_.spikeout_.clear();
     spike_.spikein_.clear();
+    spike_.bytesout_.clear();
+    spike_.bytesin_.clear();
+    spike_.spikein_shared_ = NULL;
+    spike_.nshared_ = 0;
 }
 
 inline void pool::accumulate_stats(){
     int ite_stats = 0;
     int local_stats = 0;
+    int delivered_stats = 0;
+    double deliver_time_stats = 0.;
     for(int i=0; i < thread_datas_.size(); ++i){
         ite_stats += thread_datas_[i].ite_received_;
         local_stats += thread_datas_[i].local_received_;
+        delivered_stats += thread_datas_[i].delivered_;
+        deliver_time_stats += thread_datas_[i].deliver_time_;
         assert(thread_datas_[i].get_time() == time_);
     }
 
     //ACCUMULATE ACROSS RANKS
     spike_.ite_stats_ = ite_stats;
     spike_.local_stats_ = local_stats;
+    spike_.delivered_stats_ = delivered_stats;
+    spike_.deliver_time_stats_ = deliver_time_stats;
+
+    //LOAD IMBALANCE: busiest thread / mean thread, per interval
+    std::vector<double> imbalance;
+    double busy = 0.;
+    double wall = 0.;
+    for(int i=0; i < loads_.size(); ++i){
+        if(loads_[i].mean_busy_ > 0.)
+            imbalance.push_back(loads_[i].max_busy_ / loads_[i].mean_busy_);
+        busy += loads_[i].mean_busy_;
+        wall += loads_[i].wall_;
+    }
+    spike_.interval_stats_ = imbalance.size();
+    if(!imbalance.empty()){
+        std::sort(imbalance.begin(), imbalance.end());
+        double sum = 0.;
+        for(int i=0; i < imbalance.size(); ++i)
+            sum += imbalance[i];
+        spike_.imbalance_stats_ = sum / imbalance.size();
+        spike_.p99_imbalance_stats_ = imbalance[(99 * (imbalance.size() - 1)) / 100];
+        spike_.max_imbalance_stats_ = imbalance.back();
+    }
+    if(wall > 0.)
+        spike_.idle_stats_ = 1. - busy / wall;
+}
+
+inline void pool::record_traces(){
+    traces_.assign(thread_datas_.size(), ::queue::trace());
+    for(int i=0; i < thread_datas_.size(); ++i)
+        thread_datas_[i].record_trace(&traces_[i]);
+}
+
+inline bool pool::write_traces(std::string const& name) const{
+    return ::queue::write_traces(name, traces_);
+}
+
+inline void pool::record_telemetry(){
+    telemetry_.start(thread_datas_.size(), min_delay_);
+}
+
+inline bool pool::write_telemetry(std::string const& name) const{
+    return telemetry_.write(name);
 }
 
 } //end of namespace
@@ -33,18 +33,78 @@
 
 namespace queueing {
 
+namespace {
+    /** true if the event is due at til */
+    struct due {
+        explicit due(double til):til_(til){}
+        inline bool operator()(const event& e) const { return e.t_ <= til_; }
+        double til_;
+    };
+
+    /** time order */
+    struct earlier {
+        inline bool operator()(const event& a, const event& b) const { return a.t_ < b.t_; }
+    };
+}
+
 void queue::insert(double tt, int d) {
+    if(trace_)
+        trace_->insert(tt);
     event e(d,tt);
-    pq_que.push(e);
+    pq_que.push_back(e);
+    std::push_heap(pq_que.begin(), pq_que.end(), std::greater<event>());
 }
 
 bool queue::atomic_dq(double tt, event& q) {
-    if(!pq_que.empty() && pq_que.top().t_ <= tt) {
-        q = pq_que.top();
-        pq_que.pop();
+    if(trace_)
+        trace_->dq(tt);
+    if(!pq_que.empty() && pq_que.front().t_ <= tt) {
+        q = pq_que.front();
+        std::pop_heap(pq_que.begin(), pq_que.end(), std::greater<event>());
+        pq_que.pop_back();
         return true;
     }
     return false;
 }
 
+size_t queue::count_until(size_t i, double til) const {
+    //the children are later than their parent, prune the later subtrees
+    if(i >= pq_que.size() || pq_que[i].t_ > til)
+        return 0;
+    return 1 + count_until(2*i + 1, til) + count_until(2*i + 2, til);
+}
+
+size_t queue::drain_until(double til, std::vector<event>& out) {
+    const size_t n = count_until(0, til);
+    if(trace_){
+        //same trace as the atomic_dq loop: n pops and the failing call
+        for(size_t i = 0; i <= n; ++i)
+            trace_->dq(til);
+    }
+    if(n == 0)
+        return 0;
+
+    size_t log2 = 1;
+    while((static_cast<size_t>(1) << log2) < pq_que.size())
+        ++log2;
+    const size_t first = out.size();
+    if(n * log2 < pq_que.size()){
+        //few events: n pops, O(n log(size))
+        for(size_t i = 0; i < n; ++i){
+            out.push_back(pq_que.front());
+            std::pop_heap(pq_que.begin(), pq_que.end(), std::greater<event>());
+            pq_que.pop_back();
+        }
+        return n;
+    }
+    //many events: one pass to gather them, rebuild the heap, O(size)
+    std::vector<event>::iterator it = std::partition(pq_que.begin(),
+        pq_que.end(), due(til));
+    out.insert(out.end(), pq_que.begin(), it);
+    pq_que.erase(pq_que.begin(), it);
+    std::make_heap(pq_que.begin(), pq_que.end(), std::greater<event>());
+    std::sort(out.begin() + first, out.end(), earlier());
+    return n;
+}
+
 } //end of namespace
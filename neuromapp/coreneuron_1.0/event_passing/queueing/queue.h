@@ -30,7 +30,9 @@
 #include <map>
 #include <utility>
 #include <functional>
+#include <algorithm>
 
+#include "coreneuron_1.0/queue/trace.h"
 
 #ifndef MAPP_CONTAINER_H_
 #define MAPP_CONTAINER_H_
@@ -52,6 +54,8 @@ struct event {
 
 class queue {
 public:
+    queue():trace_(NULL){}
+
     /** \fn size()
      *  \return the size of pq_que
      */
@@ -65,6 +69,17 @@ public:
      */
     bool atomic_dq(double til, event& q);
 
+    /** \fn size_t drain_until(double til, std::vector<event>& out)
+     *  \brief pops all the events with time <= til, same result as calling
+     *  atomic_dq until it fails. If they are many compared to the size of
+     *  the heap, they are gathered in one pass and the heap rebuilt,
+     *  otherwise popped one by one.
+     *  \param til a double value compared against top time.
+     *  \param out the popped events are appended in time order
+     *  \return the number of popped events
+     */
+    size_t drain_until(double til, std::vector<event>& out);
+
     /** \fn void insert(double t, int data)
      *  \brief inserts an event with time t and data value
      *  \param t the event time.
@@ -72,8 +87,21 @@ public:
      */
     void insert(double t, int data);
 
+    /** \fn void record(::queue::trace* t)
+     *  \brief records the following insert/atomic_dq calls into t, for
+     *  the trace replay of the queue miniapp (NULL stops the recording)
+     */
+    void record(::queue::trace* t) {trace_ = t;}
+
 private:
-    std::priority_queue<event, std::vector<event>, std::greater<event> > pq_que;
+    /** \fn size_t count_until(size_t i, double til)
+     *  \return the number of events <= til of the subtree of the node i
+     */
+    size_t count_until(size_t i, double til) const;
+
+    /// min-heap on the time (std::push_heap/pop_heap with std::greater)
+    std::vector<event> pq_que;
+    ::queue::trace* trace_;
 };
 
 } //end of namespace
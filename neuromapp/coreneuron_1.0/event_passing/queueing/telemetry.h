@@ -0,0 +1,288 @@
+/*
+ * Neuromapp - telemetry.h, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/queueing/telemetry.h
+ * \brief Contains the per interval telemetry of the cell groups: queue
+ * depth, inter thread inbox length and delivery time, recorded by the pool
+ * into a binary time series and summarized by the event miniapp (--summarize)
+ */
+
+#ifndef MAPP_TELEMETRY_H_
+#define MAPP_TELEMETRY_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+
+namespace queueing {
+
+/** size of a cache line: data written by different threads are kept
+ *  at least this far apart */
+static const int cache_line = 64;
+
+/** what a cell group did during one min delay interval */
+struct telemetry_sample{
+    /// events left in the queue at the end of the interval
+    unsigned int queue_depth_;
+    /// largest inter thread inbox moved into the queue in one step
+    unsigned int inbox_;
+    /// events delivered
+    unsigned int delivered_;
+    /// time spent delivering them (us)
+    float deliver_us_;
+};
+
+/** the metrics of the summary */
+enum telemetry_metric {queue_depth, inbox_length, delivered_events, deliver_latency};
+
+/** distribution of a metric over the samples */
+struct telemetry_stats{
+    telemetry_stats():n_(0),mean_(0.),p50_(0.),p99_(0.),max_(0.){}
+    int n_;
+    double mean_;
+    double p50_;
+    double p99_;
+    double max_;
+};
+
+/** binary file: "NMTL", version, number of cell groups, min delay and number
+    of intervals (unsigned int, host endianness), then the samples interval
+    by interval, cell group by cell group */
+static const char telemetry_magic[4] = {'N','M','T','L'};
+static const unsigned int telemetry_version = 1;
+
+/**
+    \brief time series of the telemetry samples. Every cell group fills its
+    slot during the interval, from the thread running it: the slots are one
+    cache line each and aligned, two groups never write the same line.
+    end_interval() appends the slots to the series, serially.
+ */
+class telemetry{
+public:
+    /** \fn telemetry()
+     *  \brief disabled until start() is called
+     */
+    telemetry():ngroups_(0),min_delay_(0),slots_(NULL){}
+
+    /** \fn ~telemetry()
+     *  \brief frees the slots
+     */
+    ~telemetry(){ free(slots_); }
+
+    /** \fn void start(int ngroups, int min_delay)
+     *  \brief allocates one slot per cell group and clears the series
+     */
+    void start(int ngroups, int min_delay){
+        free(slots_);
+        slots_ = NULL;
+        void* p = NULL;
+        if(posix_memalign(&p, cache_line, ngroups * sizeof(slot)) != 0)
+            return;
+        slots_ = static_cast<slot*>(p);
+        memset(slots_, 0, ngroups * sizeof(slot));
+        ngroups_ = ngroups;
+        min_delay_ = min_delay;
+        samples_.clear();
+    }
+
+    /** \fn bool enabled()
+     *  \return true if the samples are recorded
+     */
+    inline bool enabled() const { return slots_ != NULL; }
+
+    /** \fn telemetry_sample& current(int group)
+     *  \return the sample of the cell group for the current interval
+     */
+    inline telemetry_sample& current(int group){ return slots_[group].sample_; }
+
+    /** \fn void end_interval()
+     *  \brief appends the samples of the interval and clears the slots
+     */
+    void end_interval(){
+        for(int i = 0; i < ngroups_; ++i)
+            samples_.push_back(slots_[i].sample_);
+        memset(slots_, 0, ngroups_ * sizeof(slot));
+    }
+
+    /** \fn void push_back(const telemetry_sample& s)
+     *  \brief appends a sample to the series (reader, tests)
+     */
+    inline void push_back(const telemetry_sample& s){ samples_.push_back(s); }
+
+    /** \fn int ngroups()
+     *  \return the number of cell groups
+     */
+    inline int ngroups() const { return ngroups_; }
+
+    /** \fn int min_delay()
+     *  \return the number of steps per interval
+     */
+    inline int min_delay() const { return min_delay_; }
+
+    /** \fn int nintervals()
+     *  \return the number of complete intervals recorded
+     */
+    inline int nintervals() const { return ngroups_ ? samples_.size() / ngroups_ : 0; }
+
+    /** \fn const telemetry_sample& sample(int interval, int group)
+     *  \return the sample of the cell group for the interval
+     */
+    inline const telemetry_sample& sample(int interval, int group) const {
+        return samples_[interval * ngroups_ + group];
+    }
+
+    /** \fn bool write(std::string const& name)
+     *  \brief writes the series into the binary file name
+     *  \return false if the file can not be written
+     */
+    bool write(std::string const& name) const{
+        FILE* f = fopen(name.c_str(),"wb");
+        if(!f)
+            return false;
+        unsigned int header[4] = {telemetry_version, static_cast<unsigned int>(ngroups_),
+            static_cast<unsigned int>(min_delay_), static_cast<unsigned int>(nintervals())};
+        fwrite(telemetry_magic,1,4,f);
+        fwrite(header,sizeof(unsigned int),4,f);
+        if(!samples_.empty())
+            fwrite(&samples_[0],sizeof(telemetry_sample),header[3] * ngroups_,f);
+        bool ok = !ferror(f);
+        fclose(f);
+        return ok;
+    }
+
+    /** \fn bool read(std::string const& name)
+     *  \brief reads a series written by write(), the slots are not allocated
+     *  \return false if the file does not exist or is not a telemetry
+     */
+    bool read(std::string const& name){
+        FILE* f = fopen(name.c_str(),"rb");
+        if(!f)
+            return false;
+        char magic[4];
+        unsigned int header[4];
+        bool ok = fread(magic,1,4,f) == 4 && memcmp(magic,telemetry_magic,4) == 0
+                  && fread(header,sizeof(unsigned int),4,f) == 4
+                  && header[0] == telemetry_version;
+        if(ok){
+            ngroups_ = header[1];
+            min_delay_ = header[2];
+            samples_.resize(static_cast<size_t>(header[3]) * ngroups_);
+            ok = samples_.empty() || fread(&samples_[0],sizeof(telemetry_sample),
+                samples_.size(),f) == samples_.size();
+        }
+        fclose(f);
+        return ok;
+    }
+
+    /** \fn telemetry_stats stats(telemetry_metric m, int group)
+     *  \brief distribution of the metric over the intervals of a cell group,
+     *  over all the samples if group < 0. The delivery latency is the time
+     *  per delivered event (ns), the intervals without delivery are skipped.
+     */
+    telemetry_stats stats(telemetry_metric m, int group = -1) const{
+        std::vector<double> values;
+        for(int i = 0; i < nintervals(); ++i){
+            for(int j = 0; j < ngroups_; ++j){
+                if(group >= 0 && j != group)
+                    continue;
+                const telemetry_sample& s = sample(i, j);
+                switch(m){
+                    case queue_depth:
+                        values.push_back(s.queue_depth_);
+                        break;
+                    case inbox_length:
+                        values.push_back(s.inbox_);
+                        break;
+                    case delivered_events:
+                        values.push_back(s.delivered_);
+                        break;
+                    default:
+                        if(s.delivered_ > 0)
+                            values.push_back(1000. * s.deliver_us_ / s.delivered_);
+                }
+            }
+        }
+        telemetry_stats st;
+        st.n_ = values.size();
+        if(values.empty())
+            return st;
+        std::sort(values.begin(), values.end());
+        for(int i = 0; i < values.size(); ++i)
+            st.mean_ += values[i];
+        st.mean_ /= values.size();
+        st.p50_ = values[(values.size() - 1) / 2];
+        st.p99_ = values[(99 * (values.size() - 1)) / 100];
+        st.max_ = values.back();
+        return st;
+    }
+
+    /** \fn void summarize(std::ostream& out)
+     *  \brief prints the distribution of every metric, then the mean of
+     *  every cell group
+     */
+    void summarize(std::ostream& out) const{
+        static const char* names[] = {"queue depth", "inbox length",
+            "delivered/interval", "delivery ns/event"};
+        out<<nintervals()<<" intervals of "<<min_delay_<<" steps, "
+            <<ngroups_<<" cell groups"<<std::endl;
+        out<<std::setw(20)<<"metric"<<std::setw(12)<<"mean"<<std::setw(12)<<"p50"
+            <<std::setw(12)<<"p99"<<std::setw(12)<<"max"<<std::endl;
+        for(int m = queue_depth; m <= deliver_latency; ++m){
+            telemetry_stats st = stats(static_cast<telemetry_metric>(m));
+            out<<std::setw(20)<<names[m]<<std::setw(12)<<st.mean_<<std::setw(12)<<st.p50_
+                <<std::setw(12)<<st.p99_<<std::setw(12)<<st.max_<<std::endl;
+        }
+        out<<std::setw(20)<<"cell group";
+        for(int m = queue_depth; m <= deliver_latency; ++m)
+            out<<std::setw(20)<<names[m];
+        out<<std::endl;
+        for(int j = 0; j < ngroups_; ++j){
+            out<<std::setw(20)<<j;
+            for(int m = queue_depth; m <= deliver_latency; ++m)
+                out<<std::setw(20)<<stats(static_cast<telemetry_metric>(m), j).mean_;
+            out<<std::endl;
+        }
+    }
+
+private:
+    telemetry(const telemetry&);
+    telemetry& operator=(const telemetry&);
+
+    /** one cache line per cell group */
+    union slot{
+        telemetry_sample sample_;
+        char line_[cache_line];
+    };
+
+    int ngroups_;
+    int min_delay_;
+    slot* slots_;
+    std::vector<telemetry_sample> samples_;
+};
+
+} //end of namespace
+
+#endif
@@ -33,10 +33,11 @@
 
 namespace queueing {
 
-nrn_thread_data::nrn_thread_data():
-ite_received_(0), local_received_(0), enqueued_(0), delivered_(0) {
+/** \fn NrnThread* shared_nrnthread()
+ *  \return the NrnThread of the storage, shared by the thread datas
+ */
+static NrnThread* shared_nrnthread(){
     input_parameters p;
-    time_ = 0;
     char name[] = "coreneuron_1.0_queueing_data";
     std::string data = mapp::data_test();
     p.name = name;
@@ -44,15 +45,69 @@ ite_received_(0), local_received_(0), enqueued_(0), delivered_(0) {
     std::vector<char> chardata(data.begin(), data.end());
     chardata.push_back('\0');
     p.d = &chardata[0];
-    nt_ = (NrnThread *) storage_get(p.name, make_nrnthread, p.d, free_nrnthread);
-    if(nt_ == NULL){
+    NrnThread* nt = (NrnThread *) storage_get(p.name, make_nrnthread, p.d, free_nrnthread);
+    if(nt == NULL){
         std::cerr<<"Error: Unable to open data file"<<std::endl;
         storage_clear(p.name);
         exit(EXIT_FAILURE);
     }
+    return nt;
+}
+
+nrn_thread_data::nrn_thread_data():
+ite_received_(0), owned_(false), local_received_(0), enqueued_(0), delivered_(0),
+time_(0), deliver_time_(0.) {
+    nt_ = shared_nrnthread();
     inter_thread_events_.reserve(1000);
 }
 
+nrn_thread_data::nrn_thread_data(const nrn_thread_data& other):
+inter_thread_events_(other.inter_thread_events_),
+ite_received_(other.ite_received_), qe_(other.qe_), nt_(other.nt_), owned_(false),
+due_(other.due_), local_received_(other.local_received_), enqueued_(other.enqueued_),
+delivered_(other.delivered_), time_(other.time_), deliver_time_(other.deliver_time_) {
+    if(other.owned_)
+        clone_nrnthread();
+}
+
+nrn_thread_data& nrn_thread_data::operator=(const nrn_thread_data& other){
+    if(this == &other)
+        return *this;
+    release_nrnthread();
+    inter_thread_events_ = other.inter_thread_events_;
+    ite_received_ = other.ite_received_;
+    qe_ = other.qe_;
+    nt_ = other.nt_;
+    due_ = other.due_;
+    local_received_ = other.local_received_;
+    enqueued_ = other.enqueued_;
+    delivered_ = other.delivered_;
+    time_ = other.time_;
+    deliver_time_ = other.deliver_time_;
+    if(other.owned_)
+        clone_nrnthread();
+    return *this;
+}
+
+void nrn_thread_data::clone_nrnthread(){
+    if(owned_)
+        return;
+    nt_ = (NrnThread *) ::clone_nrnthread(nt_);
+    if(nt_ == NULL){
+        std::cerr<<"Error: Unable to clone NrnThread"<<std::endl;
+        exit(EXIT_FAILURE);
+    }
+    owned_ = true;
+}
+
+void nrn_thread_data::release_nrnthread(){
+    if(!owned_)
+        return;
+    free_nrnthread(nt_);
+    owned_ = false;
+    nt_ = shared_nrnthread();
+}
+
 void nrn_thread_data::self_send(int d, double tt){
     ++enqueued_;
     ++local_received_;
@@ -76,16 +131,18 @@ void nrn_thread_data::inter_send_no_lock(int d, double tt){
     inter_thread_events_.push_back(ite);
 }
 
-void nrn_thread_data::enqueue_my_events(){
+int nrn_thread_data::enqueue_my_events(){
     lock_.lock();
     event ite;
-    for(int i = 0; i < inter_thread_events_.size(); ++i){
+    const int n = inter_thread_events_.size();
+    for(int i = 0; i < n; ++i){
         ite = inter_thread_events_[i];
         ++enqueued_;
         qe_.insert(ite.t_, ite.data_);
     }
     inter_thread_events_.clear();
     lock_.unlock();
+    return n;
 }
 
 bool nrn_thread_data::deliver(){
@@ -102,6 +159,19 @@ bool nrn_thread_data::deliver(){
     return false;
 }
 
+int nrn_thread_data::deliver_all(){
+    double start = omp_get_wtime();
+    due_.clear();
+    const int n = qe_.drain_until(time_, due_);
+    for(int i = 0; i < n; ++i){
+        // same imitation of the point_receive as deliver()
+        mech_net_receive(nt_,&(nt_->ml[18]));
+    }
+    delivered_ += n;
+    deliver_time_ += omp_get_wtime() - start;
+    return n;
+}
+
 void nrn_thread_data::l_algebra(){
     nt_->_t = static_cast<double>(time_);
 
@@ -36,6 +36,7 @@
 #include "utils/storage/storage.h"
 
 #include "coreneuron_1.0/event_passing/queueing/queue.h"
+#include "coreneuron_1.0/event_passing/queueing/telemetry.h"
 #include "coreneuron_1.0/common/data/helper.h"
 
 // Get OMP header if available
@@ -44,20 +45,44 @@
 
 namespace queueing {
 
+/** source of the NrnThread used by each nrn_thread_data:
+ *  - shared_data: every thread uses the NrnThread of the storage
+ *  - cloned_data: every thread owns a clone of it
+ */
+enum nrnthread_source {shared_data, cloned_data};
+
+/** The members are split in two parts, one cache line apart: the inbox
+ *  written by the other cell groups (inter_thread_send), then the queue and
+ *  the counters of the thread running the cell group. The trailing line keeps
+ *  the counters away from the inbox of the next element of a vector, the
+ *  counters of the groups do not false share.
+ */
 class nrn_thread_data{
 private:
     mapp::mutex lock_;
-
-    queue qe_;
-    NrnThread* nt_;
     /// vector for inter thread events
     std::vector<event> inter_thread_events_;
 public:
     int ite_received_;
+private:
+    char shared_pad_[cache_line];
+
+    queue qe_;
+    NrnThread* nt_;
+    /// true if nt_ is a clone owned by this thread data
+    bool owned_;
+    /// events popped by deliver_all
+    std::vector<event> due_;
+public:
     int local_received_;
     int enqueued_;
     int delivered_;
     int time_;
+    /// time spent in deliver_all (s)
+    double deliver_time_;
+private:
+    char owned_pad_[cache_line];
+public:
 
     /** \fn nrn_thread_data()
      *  \brief initializes nrn_thread_data and creates a new priority queue
@@ -66,6 +91,40 @@ public:
      */
     nrn_thread_data();
 
+    /** \fn nrn_thread_data(const nrn_thread_data& other)
+     *  \brief copies other, with its own lock and its own clone of the
+     *  NrnThread if other owns one (std::vector copies the thread datas)
+     */
+    nrn_thread_data(const nrn_thread_data& other);
+
+    /** \fn nrn_thread_data& operator=(const nrn_thread_data& other)
+     *  \brief frees the clone, then copies other as the copy constructor
+     *  (the lock is kept)
+     */
+    nrn_thread_data& operator=(const nrn_thread_data& other);
+
+    /** \fn ~nrn_thread_data()
+     *  \brief frees the clone
+     */
+    ~nrn_thread_data() {release_nrnthread();}
+
+    /** \fn void clone_nrnthread()
+     *  \brief replaces the shared NrnThread by a private clone. Should be
+     *  called by the thread which will use this nrn_thread_data, so that the
+     *  clone is first-touched (and placed) by its owner.
+     */
+    void clone_nrnthread();
+
+    /** \fn void release_nrnthread()
+     *  \brief frees the private clone, back to the shared NrnThread
+     */
+    void release_nrnthread();
+
+    /** \fn const NrnThread* nrnthread()
+     *  \return the NrnThread used by this thread data
+     */
+    const NrnThread* nrnthread() const {return nt_;}
+
     /** \fn void self_send(int d, double tt)
      *  \brief send an item directly to my priority queue
      *  \param d the Event's data value
@@ -87,11 +146,12 @@ public:
      **/
     void inter_send_no_lock(int d, double tt);
 
-    /** \fn void enqeue_my_events()
+    /** \fn int enqeue_my_events()
      *  \brief (for this thread) push all the events from my
      *  ites_ to my priority queue
+     *  \return the number of events moved (inbox length)
      */
-    void enqueue_my_events();
+    int enqueue_my_events();
 
     /** \fn bool deliver(int id, int til)
      *  \brief dequeue all items with time < til
@@ -101,11 +161,23 @@ public:
      */
     bool deliver();
 
+    /** \fn int deliver_all()
+     *  \brief delivers all items with time <= time_, drained from the
+     *  queue in one call (same result as the deliver loop)
+     *  \return the number of events delivered
+     */
+    int deliver_all();
+
     /** \fn void l_algebra()
      *  \brief performs the mechanism calculations/updates for linear algebra
      */
     void l_algebra();
 
+    /** \fn void record_trace(::queue::trace* t)
+     *  \brief records the operations of my queue into t (NULL to stop)
+     */
+    void record_trace(::queue::trace* t) {qe_.record(t);}
+
     /** \fn size_t inter_thread_size()
      *  \return the size of inter_thread_events_
      */
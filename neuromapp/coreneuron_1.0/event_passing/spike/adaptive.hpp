@@ -0,0 +1,243 @@
+/*
+ * Neuromapp - adaptive.hpp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/spike/adaptive.hpp
+ * contains the dispatch between the spike exchange algorithms and the
+ * runtime selection of the fastest one (auto exchange)
+ */
+
+#ifndef MAPP_ADAPTIVE_H
+#define MAPP_ADAPTIVE_H
+
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <mpi.h>
+
+#include "coreneuron_1.0/event_passing/spike/algos.hpp"
+#include "coreneuron_1.0/event_passing/spike/distributed.hpp"
+#include "coreneuron_1.0/event_passing/spike/hierarchical.hpp"
+#include "coreneuron_1.0/event_passing/spike/targeted.hpp"
+
+/** \fn exchange_name(exchange_mode mode)
+ *  \return the name of the exchange algorithm, as given to --exchange
+ */
+inline const char* exchange_name(exchange_mode mode){
+    static const char* names[] = {"allgather", "compact", "node", "targeted",
+                                  "neighbor", "auto"};
+    return names[mode];
+}
+
+/**
+    \brief the state of the exchange algorithms which need a setup:
+    node window, destination ranks, distributed graph
+ */
+struct exchange_context{
+    exchange_mode mode_;
+    node_window window_;
+    spike_targets targets_;
+    MPI_Comm neighborhood_;
+};
+
+/**
+ * \fn create_exchange_context(exchange_mode mode, const P& presyns, int ncells)
+ * \brief sets up what the exchange mode needs (everything for auto_exchange)
+ * \param ncells the total number of cells in the simulation
+ */
+template <typename P>
+exchange_context create_exchange_context(exchange_mode mode, const P& presyns, int ncells){
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    exchange_context c;
+    c.mode_ = mode;
+    c.neighborhood_ = MPI_COMM_NULL;
+    if(mode == hierarchical_exchange || mode == auto_exchange)
+        c.window_ = create_node_window();
+    if(mode == targeted_exchange || mode == auto_exchange)
+        c.targets_ = create_spike_targets(presyns, ncells);
+    if(mode == neighbor_exchange || mode == auto_exchange)
+        c.neighborhood_ = create_dist_graph(presyns, ncells / size);
+    return c;
+}
+
+/**
+ * \fn free_exchange_context(exchange_context& c)
+ * \brief frees the node window and the distributed graph
+ */
+inline void free_exchange_context(exchange_context& c){
+    if(c.mode_ == hierarchical_exchange || c.mode_ == auto_exchange)
+        free_node_window(c.window_);
+    if(c.neighborhood_ != MPI_COMM_NULL)
+        MPI_Comm_free(&c.neighborhood_);
+}
+
+/**
+ * \fn exchange_spikes(data& d, MPI_Datatype spike, exchange_mode mode, exchange_context& c)
+ * \brief performs one spike exchange with the algorithm mode
+ * \param d the data environment on which this algo is called
+ * \param spike the MPI_Datatype being communicated
+ * \param c the context, from create_exchange_context
+ */
+template<typename data>
+void exchange_spikes(data& d, MPI_Datatype spike, exchange_mode mode, exchange_context& c){
+    switch(mode){
+        case compact_exchange:
+            compact_blocking_spike(d);
+            break;
+        case hierarchical_exchange:
+            hierarchical_spike(d, spike, c.window_);
+            break;
+        case targeted_exchange:
+            targeted_spike(d, spike, c.targets_);
+            break;
+        case neighbor_exchange:
+            distributed_spike(d, spike, c.neighborhood_);
+            break;
+        default:
+            blocking_spike(d, spike);
+    }
+}
+
+/**
+    \brief runtime selection of the spike exchange algorithm. Every candidate
+    is measured during probe_ min delay intervals, then the fastest one
+    (maximum time over the ranks) is used until the global spike rate
+    changes by more than a factor change_, which triggers a new
+    evaluation. The rate is checked every probe_ intervals with one
+    MPI_Allreduce. All the ranks take the same decisions, rank 0 logs them.
+ */
+class exchange_selector{
+public:
+    /** \fn exchange_selector(std::vector<exchange_mode> const& candidates,
+     *  int probe, double change, bool verbose)
+     *  \param candidates the algorithms to choose from
+     *  \param probe the number of intervals measured per candidate (K)
+     *  \param change the spike rate ratio triggering a new evaluation
+     *  \param verbose rank 0 prints the decisions
+     */
+    exchange_selector(std::vector<exchange_mode> const& candidates, int probe = 3,
+                      double change = 2., bool verbose = true):
+    candidates_(candidates), probe_(probe), change_(change), verbose_(verbose),
+    probing_(true), candidate_(0), count_(0), interval_(0), spikes_(0.), rate_(0.),
+    times_(candidates.size(), 0.){}
+
+    /** \fn mode()
+     *  \return the algorithm of the next exchange
+     */
+    inline exchange_mode mode() const { return candidates_[candidate_]; }
+
+    /** \fn record(double time, int nspikes)
+     *  \brief accounts for the exchange of an interval, collective
+     *  \param time the time spent by this rank in the exchange and in the
+     *  decode of the received spikes (pool::filter for the compact and
+     *  hierarchical exchanges)
+     *  \param nspikes the spikes sent by this rank
+     */
+    void record(double time, int nspikes){
+        ++interval_;
+        ++count_;
+        spikes_ += nspikes;
+        if(probing_){
+            times_[candidate_] += time;
+            if(count_ < probe_)
+                return;
+            count_ = 0;
+            if(++candidate_ < candidates_.size())
+                return;
+            //every candidate measured: the slowest rank decides
+            MPI_Allreduce(MPI_IN_PLACE, &times_[0], times_.size(), MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            rate_ = global_rate();
+            candidate_ = 0;
+            for(int i = 1; i < times_.size(); ++i){
+                if(times_[i] < times_[candidate_])
+                    candidate_ = i;
+            }
+            probing_ = false;
+            decisions_.push_back(std::make_pair(interval_, mode()));
+            log();
+            return;
+        }
+        if(count_ < probe_)
+            return;
+        count_ = 0;
+        const double rate = global_rate();
+        if(rate + 1. > change_ * (rate_ + 1.) || change_ * (rate + 1.) < rate_ + 1.){
+            if(verbose_ && rank() == 0)
+                std::cout<<"auto exchange: interval "<<interval_<<", spike rate "
+                    <<rate_<<" -> "<<rate<<" per interval, new evaluation"<<std::endl;
+            probing_ = true;
+            candidate_ = 0;
+            std::fill(times_.begin(), times_.end(), 0.);
+        }
+    }
+
+    /** \fn decisions()
+     *  \return the interval and the algorithm of every selection
+     */
+    inline const std::vector<std::pair<int, exchange_mode> >& decisions() const { return decisions_; }
+
+    /** \fn probing()
+     *  \return true while the candidates are measured
+     */
+    inline bool probing() const { return probing_; }
+
+private:
+    static int rank(){
+        int r;
+        MPI_Comm_rank(MPI_COMM_WORLD, &r);
+        return r;
+    }
+
+    /** global spikes per interval since the last call, resets the count */
+    double global_rate(){
+        double spikes = spikes_;
+        MPI_Allreduce(MPI_IN_PLACE, &spikes, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        const int n = probing_ ? probe_ * candidates_.size() : probe_;
+        spikes_ = 0.;
+        return spikes / n;
+    }
+
+    void log() const{
+        if(!verbose_ || rank() != 0)
+            return;
+        std::cout<<"auto exchange: interval "<<interval_<<", "<<rate_
+            <<" spikes per interval, selected "<<exchange_name(mode())<<" (";
+        for(int i = 0; i < candidates_.size(); ++i)
+            std::cout<<(i ? ", " : "")<<exchange_name(candidates_[i])<<" "
+                <<1e6 * times_[i] / probe_<<" us";
+        std::cout<<")"<<std::endl;
+    }
+
+    std::vector<exchange_mode> candidates_;
+    int probe_;
+    double change_;
+    bool verbose_;
+    bool probing_;
+    int candidate_;     // candidate being measured, or selected
+    int count_;         // intervals in the current window
+    int interval_;
+    double spikes_;     // spikes sent by this rank in the current window
+    double rate_;       // global spikes per interval at the last selection
+    std::vector<double> times_;
+    std::vector<std::pair<int, exchange_mode> > decisions_;
+};
+
+#endif
@@ -42,6 +42,18 @@
 //define events as spike_item
 typedef queueing::event spike_item;
 
+/** spike exchange algorithm of the drivers:
+ *  - allgather_exchange: blocking_spike
+ *  - compact_exchange: compact_blocking_spike
+ *  - hierarchical_exchange: hierarchical_spike (spike/hierarchical.hpp)
+ *  - targeted_exchange: targeted_spike (spike/targeted.hpp)
+ *  - neighbor_exchange: distributed_spike (spike/distributed.hpp)
+ *  - auto_exchange: the fastest of the above, selected at runtime
+ *  (spike/adaptive.hpp)
+ */
+enum exchange_mode {allgather_exchange = 0, compact_exchange, hierarchical_exchange,
+                    targeted_exchange, neighbor_exchange, auto_exchange};
+
 /**
  * \fn create_spike_type()
  * \brief creates an MPI_Datatype required for MPI
@@ -153,6 +165,91 @@ void set_displ(data& d){
     d.spikein_.resize(total);
 }
 
+/**
+ * \fn accumulate_exchange_stats(data& d)
+ * \brief reduces the bytes exchanged and the exchange latency to rank 0
+ * and prints them. The latency is the maximum over the ranks.
+ * \param d the data environment on which this algo is called
+ */
+template<typename data>
+void accumulate_exchange_stats(data& d){
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    if (rank == 0){
+        MPI_Reduce(MPI_IN_PLACE, &(d.bytes_sent_stats_), 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        MPI_Reduce(MPI_IN_PLACE, &(d.bytes_received_stats_), 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        MPI_Reduce(MPI_IN_PLACE, &(d.exchange_time_stats_), 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    }
+    else{
+        MPI_Reduce(&(d.bytes_sent_stats_), &(d.bytes_sent_stats_), 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        MPI_Reduce(&(d.bytes_received_stats_), &(d.bytes_received_stats_), 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        MPI_Reduce(&(d.exchange_time_stats_), &(d.exchange_time_stats_), 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    }
+
+    if(rank == 0){
+        std::cout<<"Total Bytes sent: "<<d.bytes_sent_stats_<<std::endl;
+        std::cout<<"Total Bytes received: "<<d.bytes_received_stats_<<std::endl;
+        if(d.exchange_stats_ > 0)
+            std::cout<<"Exchange latency: "<<1e6 * d.exchange_time_stats_ / d.exchange_stats_
+                <<" us ("<<d.exchange_stats_<<" exchanges)"<<std::endl;
+    }
+}
+
+/**
+ * \fn accumulate_load_stats(data& d)
+ * \brief reduces the load imbalance of the threads to rank 0 and prints it.
+ * The imbalance of an interval is the time of the busiest thread over the
+ * mean time of the threads, 1 if perfectly balanced. Mean and idle fraction
+ * are averaged over the ranks, p99 and max are the worst rank.
+ * \param d the data environment on which this algo is called
+ */
+template<typename data>
+void accumulate_load_stats(data& d){
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    double sums[2] = {d.imbalance_stats_, d.idle_stats_};
+    double maxs[2] = {d.p99_imbalance_stats_, d.max_imbalance_stats_};
+    if (rank == 0){
+        MPI_Reduce(MPI_IN_PLACE, sums, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        MPI_Reduce(MPI_IN_PLACE, maxs, 2, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    }
+    else{
+        MPI_Reduce(sums, sums, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        MPI_Reduce(maxs, maxs, 2, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    }
+
+    if(rank == 0 && d.interval_stats_ > 0){
+        std::cout<<"Load imbalance (busiest/mean thread per interval): mean "<<sums[0] / size
+            <<", p99 "<<maxs[0]<<", max "<<maxs[1]<<" ("<<d.interval_stats_<<" intervals)"<<std::endl;
+        std::cout<<"Thread idle time: "<<100. * sums[1] / size<<" %"<<std::endl;
+    }
+}
+
+/**
+ * \fn accumulate_delivery_stats(data& d)
+ * \brief reduces the events delivered from the queues and the time spent
+ * delivering them (all the threads) to rank 0, prints the throughput
+ * \param d the data environment on which this algo is called
+ */
+template<typename data>
+void accumulate_delivery_stats(data& d){
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    double sums[2] = {static_cast<double>(d.delivered_stats_), d.deliver_time_stats_};
+    if (rank == 0)
+        MPI_Reduce(MPI_IN_PLACE, sums, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    else
+        MPI_Reduce(sums, sums, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if(rank == 0 && sums[1] > 0.)
+        std::cout<<"Delivered events: "<<sums[0]<<", "<<sums[0] / (1e6 * sums[1])
+            <<" events/us per thread"<<std::endl;
+}
+
 template<typename data>
 void accumulate_stats(data& d){
     int rank;
@@ -181,6 +278,10 @@ void accumulate_stats(data& d){
         std::cout<<"Total Post-spike Events: "<<d.post_spike_stats_<<std::endl;
         std::cout<<"Total Received spikes: "<<d.received_spike_stats_<<std::endl;
     }
+
+    accumulate_exchange_stats(d);
+    accumulate_load_stats(d);
+    accumulate_delivery_stats(d);
 }
 
 template<>
@@ -212,6 +313,10 @@ void accumulate_stats<spike::spike_interface_stats_collector>(spike::spike_inter
         std::cout<<"Total Received spikes: "<<d.received_spike_stats_<<std::endl;
     }
 
+    accumulate_exchange_stats(d);
+    accumulate_load_stats(d);
+    accumulate_delivery_stats(d);
+
     //std::cout <<"Printing Allgather times"<<std::endl;
     std::copy( d.allgather_times_.begin(), d.allgather_times_.end(), std::ostream_iterator<double>( d.outfile_allgather, "\n"));
     std::vector<std::pair<int,double> >::iterator it;
@@ -249,6 +354,10 @@ void accumulate_stats<spike::spike_interface_stats_collector_large_mpi>(spike::s
         std::cout<<"Total Received spikes: "<<d.received_spike_stats_<<std::endl;
     }
 
+    accumulate_exchange_stats(d);
+    accumulate_load_stats(d);
+    accumulate_delivery_stats(d);
+
     if (rank == 0){
 
 	std::cout << "Collecting statistical information from all the ranks" << std::endl;
@@ -335,12 +444,80 @@ void accumulate_stats<spike::spike_interface_stats_collector_large_mpi>(spike::s
  */
 template<typename data>
 void blocking_spike(data& d, MPI_Datatype spike){
+    int type_size;
+    MPI_Type_size(spike, &type_size);
+    double t0 = MPI_Wtime();
     //gather how many spikes each process is sending
     allgather(d);
     //set the displacements
     set_displ(d);
     //next distribute items to every other process using allgatherv
     allgatherv(d, spike);
+    d.exchange_time_stats_ += MPI_Wtime() - t0;
+    ++d.exchange_stats_;
+    d.bytes_sent_stats_ += static_cast<double>(d.spikeout_.size()) * type_size;
+    d.bytes_received_stats_ += static_cast<double>(d.spikein_.size()) * type_size;
+}
+
+//COMPACT ENCODING
+/**
+ * \fn compact_allgather(data& d)
+ * \brief encodes spikeout_ into bytesout_ and gathers how many bytes
+ * each process is sending
+ * \param d the data environment on which this algo is called
+ */
+template<typename data>
+void compact_allgather(data& d){
+    d.bytesout_.clear();
+    d.codec_.encode(d.spikeout_, d.bytesout_);
+    int send_size = d.bytesout_.size();
+    MPI_Allgather(&send_size, 1, MPI_INT, &(d.nin_[0]), 1, MPI_INT, MPI_COMM_WORLD);
+}
+
+/**
+ * \fn compact_set_displ(data& d)
+ * \brief sets the byte displacements needed for the compact allgatherv
+ * \param d the data environment on which this algo is called
+ */
+template<typename data>
+void compact_set_displ(data& d){
+    d.displ_[0] = 0;
+    int total = d.nin_[0];
+    for(int i=1; i < d.nin_.size(); ++i){
+        d.displ_[i] = total;
+        total += d.nin_[i];
+    }
+    d.bytesin_.resize(total);
+}
+
+/**
+ * \fn compact_allgatherv(data& d)
+ * \brief performs the blocking collective, MPI_Allgatherv, on the
+ * encoded bytes. The received segments are decoded by pool::filter
+ * \param d the data environment on which this algo is called
+ */
+template<typename data>
+void compact_allgatherv(data& d){
+    MPI_Allgatherv(&(d.bytesout_[0]), d.bytesout_.size(), MPI_BYTE,
+        &(d.bytesin_[0]), &(d.nin_[0]), &(d.displ_[0]), MPI_BYTE, MPI_COMM_WORLD);
+}
+
+/**
+ * \fn compact_blocking_spike(data& d)
+ * \brief performs a blocking spike exchange using the compact encoding
+ * (see spike/encoding.h) instead of the spike MPI_Datatype
+ * \param d the data environment on which this algo is called
+ */
+template<typename data>
+void compact_blocking_spike(data& d){
+    double t0 = MPI_Wtime();
+    compact_allgather(d);
+    compact_set_displ(d);
+    compact_allgatherv(d);
+    d.exchange_time_stats_ += MPI_Wtime() - t0;
+    ++d.exchange_stats_;
+    d.bytes_sent_stats_ += d.bytesout_.size();
+    d.bytes_received_stats_ += d.bytesin_.size();
 }
 
 #endif
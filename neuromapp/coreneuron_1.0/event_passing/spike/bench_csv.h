@@ -0,0 +1,179 @@
+/*
+ * Neuromapp - bench_csv.h, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/spike/bench_csv.h
+ * contains the consolidated csv of the spike exchange micro benchmark,
+ * appended by the spike_bench executable for every rank count of a sweep
+ * and compared with a baseline by the spike_bench miniapp
+ */
+
+#ifndef MAPP_BENCH_CSV_H
+#define MAPP_BENCH_CSV_H
+
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+/**
+    \brief one line of the csv: a configuration and its measurements
+ */
+struct bench_result{
+    bench_result():ranks_(0), spikes_(0), reps_(0), p50_us_(0.), p99_us_(0.),
+    mean_us_(0.), bytes_sent_(0.), bytes_received_(0.){}
+    int ranks_;
+    int spikes_;                // spikes sent per rank and exchange
+    std::string exchange_;      // allgather, node, targeted or neighbor
+    std::string encoding_;      // struct or compact
+    int reps_;
+    double p50_us_;             // exchange latency (slowest rank)
+    double p99_us_;
+    double mean_us_;
+    double bytes_sent_;         // per rank and exchange, mean over the ranks
+    double bytes_received_;
+};
+
+/** \fn bench_csv_header()
+ *  \return the first line of the csv
+ */
+inline const char* bench_csv_header(){
+    return "ranks,spikes_per_rank,exchange,encoding,reps,p50_us,p99_us,mean_us,"
+           "bytes_sent_per_rank,bytes_received_per_rank";
+}
+
+/** \fn bench_split(std::string const& list)
+ *  \return the items of a comma separated list
+ */
+inline std::vector<std::string> bench_split(std::string const& list){
+    std::vector<std::string> items;
+    std::stringstream s(list);
+    std::string item;
+    while(std::getline(s, item, ','))
+        items.push_back(item);
+    return items;
+}
+
+/** \fn bench_csv_line(const bench_result& r)
+ *  \return the csv line of r, without end of line
+ */
+inline std::string bench_csv_line(const bench_result& r){
+    std::stringstream s;
+    s<<r.ranks_<<","<<r.spikes_<<","<<r.exchange_<<","<<r.encoding_<<","<<r.reps_<<","
+     <<r.p50_us_<<","<<r.p99_us_<<","<<r.mean_us_<<","<<r.bytes_sent_<<","<<r.bytes_received_;
+    return s.str();
+}
+
+/** \fn parse_bench_line(std::string const& line, bench_result& r)
+ *  \brief reads a line written by bench_csv_line
+ *  \return false for the header or a malformed line
+ */
+inline bool parse_bench_line(std::string const& line, bench_result& r){
+    std::vector<std::string> f = bench_split(line);
+    if(f.size() != 10)
+        return false;
+    char* end;
+    r.ranks_ = strtol(f[0].c_str(), &end, 10);
+    if(*end != '\0' || f[0].empty())
+        return false;
+    r.spikes_ = atoi(f[1].c_str());
+    r.exchange_ = f[2];
+    r.encoding_ = f[3];
+    r.reps_ = atoi(f[4].c_str());
+    r.p50_us_ = atof(f[5].c_str());
+    r.p99_us_ = atof(f[6].c_str());
+    r.mean_us_ = atof(f[7].c_str());
+    r.bytes_sent_ = atof(f[8].c_str());
+    r.bytes_received_ = atof(f[9].c_str());
+    return true;
+}
+
+/** \fn read_bench_csv(std::string const& name, std::vector<bench_result>& results)
+ *  \brief appends the lines of the csv name to results
+ *  \return false if the file can not be read
+ */
+inline bool read_bench_csv(std::string const& name, std::vector<bench_result>& results){
+    std::ifstream in(name.c_str());
+    if(!in)
+        return false;
+    std::string line;
+    bench_result r;
+    while(std::getline(in, line)){
+        if(parse_bench_line(line, r))
+            results.push_back(r);
+    }
+    return true;
+}
+
+/** \fn append_bench_csv(std::string const& name, const bench_result& r)
+ *  \brief appends r to the csv name, the header is written first if the
+ *  file is new
+ *  \return false if the file can not be written
+ */
+inline bool append_bench_csv(std::string const& name, const bench_result& r){
+    bool fresh = !std::ifstream(name.c_str()).good();
+    std::ofstream out(name.c_str(), std::ios::app);
+    if(!out)
+        return false;
+    if(fresh)
+        out<<bench_csv_header()<<std::endl;
+    out<<bench_csv_line(r)<<std::endl;
+    return out.good();
+}
+
+/** \fn compare_bench(std::vector<bench_result> const& current,
+ *  std::vector<bench_result> const& baseline, std::ostream& out)
+ *  \brief prints, for every configuration measured in both, the speedup of
+ *  the p50 and p99 latencies (baseline/current) and the ratio of the bytes
+ *  per rank (current/baseline)
+ *  \return the number of configurations compared
+ */
+inline int compare_bench(std::vector<bench_result> const& current,
+                         std::vector<bench_result> const& baseline, std::ostream& out){
+    int n = 0;
+    out<<std::setw(6)<<"ranks"<<std::setw(10)<<"spikes"<<std::setw(11)<<"exchange"
+       <<std::setw(9)<<"encoding"<<std::setw(13)<<"p50 speedup"<<std::setw(13)<<"p99 speedup"
+       <<std::setw(13)<<"bytes ratio"<<std::endl;
+    for(int i = 0; i < current.size(); ++i){
+        const bench_result& c = current[i];
+        for(int j = 0; j < baseline.size(); ++j){
+            const bench_result& b = baseline[j];
+            if(b.ranks_ != c.ranks_ || b.spikes_ != c.spikes_ ||
+               b.exchange_ != c.exchange_ || b.encoding_ != c.encoding_)
+                continue;
+            const double bytes = b.bytes_sent_ + b.bytes_received_;
+            out<<std::setw(6)<<c.ranks_<<std::setw(10)<<c.spikes_<<std::setw(11)<<c.exchange_
+               <<std::setw(9)<<c.encoding_
+               <<std::setw(13)<<(c.p50_us_ > 0. ? b.p50_us_ / c.p50_us_ : 0.)
+               <<std::setw(13)<<(c.p99_us_ > 0. ? b.p99_us_ / c.p99_us_ : 0.)
+               <<std::setw(13)<<(bytes > 0. ? (c.bytes_sent_ + c.bytes_received_) / bytes : 0.)
+               <<std::endl;
+            ++n;
+            break;
+        }
+    }
+    return n;
+}
+
+#endif
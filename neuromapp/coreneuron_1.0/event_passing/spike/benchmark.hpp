@@ -0,0 +1,132 @@
+/*
+ * Neuromapp - benchmark.hpp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/spike/benchmark.hpp
+ * contains the measure of one configuration of the spike exchange micro
+ * benchmark (spike_bench executable)
+ */
+
+#ifndef MAPP_SPIKE_BENCHMARK_H
+#define MAPP_SPIKE_BENCHMARK_H
+
+#include <algorithm>
+#include <vector>
+#include <mpi.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include "coreneuron_1.0/event_passing/spike/adaptive.hpp"
+#include "coreneuron_1.0/event_passing/spike/bench_csv.h"
+
+/** \fn bench_supported(exchange_mode mode, bool compact)
+ *  \return true if the exchange has a compact variant, or compact is false
+ */
+inline bool bench_supported(exchange_mode mode, bool compact){
+    return !compact || mode == allgather_exchange || mode == neighbor_exchange;
+}
+
+/**
+ * \fn bench_exchange(data& d, MPI_Datatype spike, exchange_mode mode, bool compact, exchange_context& c)
+ * \brief one spike exchange, with the struct or the compact encoding
+ */
+template<typename data>
+void bench_exchange(data& d, MPI_Datatype spike, exchange_mode mode, bool compact,
+                    exchange_context& c){
+    if(compact && mode == neighbor_exchange)
+        compact_distributed_spike(d, c.neighborhood_);
+    else if(compact)
+        compact_blocking_spike(d);
+    else
+        exchange_spikes(d, spike, mode, c);
+}
+
+/**
+ * \fn run_bench(data& d, MPI_Datatype spike, std::vector<int> const& gids,
+ * exchange_mode mode, bool compact, int spikes, int reps, int mindelay,
+ * exchange_context& c, unsigned int seed)
+ * \brief measures reps exchanges of spikes spikes per rank, after one
+ * exchange of warm up, collective. The spikes are drawn from the local gids,
+ * the times in successive min delay intervals. The latency of an exchange is
+ * the one of the slowest rank (between two barriers).
+ * \param gids the local gids, not empty
+ * \return the measures, significant on every rank
+ */
+template<typename data>
+bench_result run_bench(data& d, MPI_Datatype spike, std::vector<int> const& gids,
+                       exchange_mode mode, bool compact, int spikes, int reps,
+                       int mindelay, exchange_context& c, unsigned int seed){
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    boost::mt19937 rng(seed + rank);
+    boost::random::uniform_int_distribution<> gid_d(0, gids.size() - 1);
+    boost::random::uniform_real_distribution<> time_d(0., mindelay);
+
+    std::vector<double> times;
+    double bytes[2] = {0., 0.};
+    for(int rep = -1; rep < reps; ++rep){
+        if(rep == 0){
+            bytes[0] = d.bytes_sent_stats_;
+            bytes[1] = d.bytes_received_stats_;
+        }
+        d.spikeout_.clear();
+        queueing::event e;
+        for(int i = 0; i < spikes; ++i){
+            e.data_ = gids[gid_d(rng)];
+            e.t_ = (rep + 1) * mindelay + time_d(rng);
+            d.spikeout_.push_back(e);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+        double t0 = MPI_Wtime();
+        bench_exchange(d, spike, mode, compact, c);
+        if(rep >= 0)
+            times.push_back(MPI_Wtime() - t0);
+        d.spikein_.clear();
+        d.bytesout_.clear();
+        d.bytesin_.clear();
+        d.spikein_shared_ = NULL;
+        d.nshared_ = 0;
+    }
+    bytes[0] = d.bytes_sent_stats_ - bytes[0];
+    bytes[1] = d.bytes_received_stats_ - bytes[1];
+
+    bench_result r;
+    r.ranks_ = size;
+    r.spikes_ = spikes;
+    r.exchange_ = exchange_name(mode);
+    r.encoding_ = compact ? "compact" : "struct";
+    r.reps_ = reps;
+    if(reps == 0)
+        return r;
+    MPI_Allreduce(MPI_IN_PLACE, &times[0], reps, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, bytes, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    std::sort(times.begin(), times.end());
+    for(int i = 0; i < reps; ++i)
+        r.mean_us_ += 1e6 * times[i];
+    r.mean_us_ /= reps;
+    r.p50_us_ = 1e6 * times[(reps - 1) / 2];
+    r.p99_us_ = 1e6 * times[(99 * (reps - 1)) / 100];
+    r.bytes_sent_ = bytes[0] / (size * reps);
+    r.bytes_received_ = bytes[1] / (size * reps);
+    return r;
+}
+#endif
@@ -29,6 +29,7 @@
 #include <assert.h>
 #include <cstddef>
 #include <vector>
+#include <algorithm>
 #include <mpi.h>
 
 #include "coreneuron_1.0/event_passing/queueing/queue.h"
@@ -37,9 +38,10 @@
 
 #if MPI_VERSION >= 3
 /**
- * \fn create_dist_graph(P& presyns, int ncells)
+ * \fn create_dist_graph_bcast(P& presyns, int ncells)
  * \brief Creates a distributed graph topology in order to perform nearest
- * neighbor communication.
+ * neighbor communication. Original version, 2 x nprocs sequential
+ * broadcasts, kept as a reference for create_dist_graph.
  *
  *Summary:
  * - Uses MPI broadcast in order to exchange information about the cells
@@ -55,15 +57,12 @@
  * - Use this information to construct topology.
  */
 template <typename P>
-MPI_Comm create_dist_graph(P& presyns, int ncells){
+MPI_Comm create_dist_graph_bcast(P& presyns, int ncells){
     MPI_Comm neighborhood;
     int size;
     int rank;
     MPI_Comm_size(MPI_COMM_WORLD, &size);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    //passed in as argument but not used
-    environment::presyn dummy_input;
-
     //create a temporary buffer for sending
     std::vector<int> sendbuf;
     std::vector<int> outNeighbors;
@@ -136,6 +135,75 @@ MPI_Comm create_dist_graph(P& presyns, int ncells){
     return neighborhood;
 }
 
+/**
+ * \fn create_dist_graph(P& presyns, int ncells)
+ * \brief Creates a distributed graph topology in order to perform nearest
+ * neighbor communication, same communicator as create_dist_graph_bcast.
+ *
+ *Summary:
+ * - Rank i owns the gids [i * ncells, (i+1) * ncells), so the inNeighbors
+ *   (ranks owning a gid with a local input presyn) are found locally, from
+ *   the sorted gids of the input presyns (O(#inputs)).
+ *
+ * - MPI_Reduce_scatter_block of the inNeighbor flags gives every rank
+ *   its number of outNeighbors.
+ *
+ * - Every rank sends one message to each of its inNeighbors, and receives
+ *   from any source as many messages as it has outNeighbors (sparse
+ *   exchange, O(degree) messages instead of 2 x nprocs broadcasts).
+ *
+ * - Use this information to construct topology.
+ */
+template <typename P>
+MPI_Comm create_dist_graph(P& presyns, int ncells){
+    MPI_Comm neighborhood;
+    int size;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    std::vector<int> outNeighbors;
+    std::vector<int> inNeighbors;
+    std::vector<int> flags(size, 0);
+
+    //add the owner of every input presyn to inNeighbors, the gids are
+    //sorted so the inNeighbors are in increasing order
+    std::vector<int> inputs;
+    presyns.input_gids(inputs);
+    for(int k = 0; k < inputs.size(); ++k){
+        const int owner = inputs[k] / ncells;
+        if(owner == rank || owner >= size || flags[owner])
+            continue;
+        inNeighbors.push_back(owner);
+        flags[owner] = 1;
+    }
+
+    //number of ranks having me as an inNeighbor
+    int nout = 0;
+    MPI_Reduce_scatter_block(&flags[0], &nout, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+    //tell the inNeighbors, they add me as outNeighbor
+    const int tag = 0xd157;
+    std::vector<MPI_Request> requests(inNeighbors.size());
+    for(int i = 0; i < inNeighbors.size(); ++i){
+        MPI_Isend(&rank, 1, MPI_INT, inNeighbors[i], tag, MPI_COMM_WORLD, &requests[i]);
+    }
+    outNeighbors.resize(nout);
+    for(int i = 0; i < nout; ++i){
+        MPI_Recv(&outNeighbors[i], 1, MPI_INT, MPI_ANY_SOURCE, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    }
+    if(!requests.empty())
+        MPI_Waitall(requests.size(), &requests[0], MPI_STATUSES_IGNORE);
+    //same neighbor order as the broadcast version
+    std::sort(outNeighbors.begin(), outNeighbors.end());
+
+    MPI_Dist_graph_create_adjacent(MPI_COMM_WORLD, inNeighbors.size(),
+        &inNeighbors[0], (int*)MPI_UNWEIGHTED, outNeighbors.size(),
+        &outNeighbors[0], (int*)MPI_UNWEIGHTED, MPI_INFO_NULL,
+        false, &neighborhood);
+    return neighborhood;
+}
+
 template<typename data>
 void neighbor_allgather(data& d, MPI_Comm neighborhood){
     int send_size = d.spikeout_.size();
@@ -157,12 +225,47 @@ void neighbor_allgatherv(data& d, MPI_Datatype spike, MPI_Comm neighborhood){
  */
 template<typename data>
 void distributed_spike(data& d, MPI_Datatype spike, MPI_Comm neighborhood){
+    int type_size;
+    MPI_Type_size(spike, &type_size);
+    double t0 = MPI_Wtime();
+    //only the in-neighbors entries are written, clear the others
+    std::fill(d.nin_.begin(), d.nin_.end(), 0);
     //gather how many spikes each process is sending
     neighbor_allgather(d, neighborhood);
     //set the displacements
     set_displ(d);
     //next distribute items to every other process using allgatherv
     neighbor_allgatherv(d, spike, neighborhood);
+    d.exchange_time_stats_ += MPI_Wtime() - t0;
+    ++d.exchange_stats_;
+    d.bytes_sent_stats_ += static_cast<double>(d.spikeout_.size()) * type_size;
+    d.bytes_received_stats_ += static_cast<double>(d.spikein_.size()) * type_size;
+}
+
+/**
+ * \fn compact_distributed_spike(data& d, MPI_Comm neighborhood)
+ * \brief performs a spike exchange for distributed graph using
+ * the compact encoding (see spike/encoding.h)
+ * \param d the data environment on which this algo is called
+ * \param neighborhood the distributed graph communicator
+ */
+template<typename data>
+void compact_distributed_spike(data& d, MPI_Comm neighborhood){
+    double t0 = MPI_Wtime();
+    d.bytesout_.clear();
+    d.codec_.encode(d.spikeout_, d.bytesout_);
+    int send_size = d.bytesout_.size();
+    //only the in-neighbors entries are written, clear the others so
+    //no stale bytes end up in the decoded buffer
+    std::fill(d.nin_.begin(), d.nin_.end(), 0);
+    MPI_Neighbor_allgather(&send_size, 1, MPI_INT, &d.nin_[0], 1, MPI_INT, neighborhood);
+    compact_set_displ(d);
+    MPI_Neighbor_allgatherv(&d.bytesout_[0], d.bytesout_.size(), MPI_BYTE,
+        &d.bytesin_[0], &d.nin_[0], &d.displ_[0], MPI_BYTE, neighborhood);
+    d.exchange_time_stats_ += MPI_Wtime() - t0;
+    ++d.exchange_stats_;
+    d.bytes_sent_stats_ += d.bytesout_.size();
+    d.bytes_received_stats_ += d.bytesin_.size();
 }
 #else
 /**
@@ -175,6 +278,12 @@ MPI_Comm create_dist_graph(P& presyns, int ncells){
     exit(EXIT_FAILURE);
 }
 
+template <typename P>
+MPI_Comm create_dist_graph_bcast(P& presyns, int ncells){
+    std::cerr<<"MPI version is < 3. Cannot use distributed graph implementation"<<std::endl;
+    exit(EXIT_FAILURE);
+}
+
 template<typename data>
 void neighbor_allgather(data& d, MPI_Comm neighborhood){
     std::cerr<<"MPI version is < 3. Cannot use distributed graph implementation"<<std::endl;
@@ -193,6 +302,12 @@ void distributed_spike(data& d, MPI_Datatype spike, MPI_Comm neighborhood){
     exit(EXIT_FAILURE);
 }
 
+template<typename data>
+void compact_distributed_spike(data& d, MPI_Comm neighborhood){
+    std::cerr<<"MPI version is < 3. Cannot use distributed graph implementation"<<std::endl;
+    exit(EXIT_FAILURE);
+}
+
 #endif //MPI VERSION 3
 
 #endif
@@ -0,0 +1,209 @@
+/*
+ * Neuromapp - encoding.h, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/spike/encoding.h
+ * \brief Contains the compact wire encoding of exchanged spikes.
+ */
+
+#ifndef MAPP_SPIKE_ENCODING_H
+#define MAPP_SPIKE_ENCODING_H
+
+#include <assert.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include "coreneuron_1.0/event_passing/queueing/queue.h"
+
+namespace spike {
+
+/** \fn gid_less(const queueing::event& a, const queueing::event& b)
+ *  \brief orders spikes by source gid, used before delta encoding
+ */
+inline bool gid_less(const queueing::event& a, const queueing::event& b){
+    return a.data_ < b.data_;
+}
+
+/**
+    \brief compact_codec packs the spikes of one sender into a byte segment.
+
+    Segment layout (all fields little endian as produced by the host):
+        - number of spikes                    (varint)
+        - width of a time offset: 2 or 4      (1 byte)
+        - base time t0 of the segment         (8 bytes, double)
+        - for every spike, sorted by gid:
+            - gid delta to the previous gid   (varint, first one absolute)
+            - (t - t0) / resolution           (2 or 4 bytes)
+
+    Spike times lie in a single min_delay interval, so the offsets
+    nearly always fit on 16 bits; the 32 bit form is used otherwise.
+    Times are quantized to the resolution (one timestep by default).
+    An empty spike list produces an empty segment, segments are self
+    delimiting so the receiver decodes the concatenated allgatherv
+    buffer without the displacements.
+ */
+class compact_codec {
+public:
+    /** \fn compact_codec(double resolution)
+     *  \brief creates a codec
+     *  \param resolution the time quantum of the encoded offsets
+     */
+    explicit compact_codec(double resolution = 1.):resolution_(resolution){}
+
+    /** \fn void encode(std::vector<queueing::event>& spikes, std::vector<unsigned char>& out)
+     *  \brief appends the segment of spikes to out
+     *  \param spikes the outgoing spikes, sorted by gid on return
+     *  \param out the byte buffer sent on the wire
+     */
+    void encode(std::vector<queueing::event>& spikes, std::vector<unsigned char>& out) const {
+        if(spikes.empty())
+            return;
+        std::sort(spikes.begin(), spikes.end(), gid_less);
+
+        double t0 = spikes[0].t_;
+        double t1 = spikes[0].t_;
+        for(size_t i = 1; i < spikes.size(); ++i){
+            t0 = std::min(t0, spikes[i].t_);
+            t1 = std::max(t1, spikes[i].t_);
+        }
+        const unsigned char width =
+            (quantize(t1, t0) <= std::numeric_limits<unsigned short>::max()) ? 2 : 4;
+
+        put_varint(spikes.size(), out);
+        out.push_back(width);
+        put_raw(&t0, sizeof(double), out);
+
+        unsigned int previous = 0;
+        for(size_t i = 0; i < spikes.size(); ++i){
+            const unsigned int gid = static_cast<unsigned int>(spikes[i].data_);
+            put_varint(gid - previous, out);
+            previous = gid;
+            if(width == 2){
+                const unsigned short off = static_cast<unsigned short>(quantize(spikes[i].t_, t0));
+                put_raw(&off, sizeof(off), out);
+            }
+            else{
+                const unsigned int off = quantize(spikes[i].t_, t0);
+                put_raw(&off, sizeof(off), out);
+            }
+        }
+    }
+
+    /** \fn double resolution() const
+     *  \return the time quantum of the encoded offsets
+     */
+    double resolution() const { return resolution_; }
+
+    /** \fn unsigned int quantize(double t, double t0) const
+     *  \return the offset of t from t0 in units of resolution
+     */
+    unsigned int quantize(double t, double t0) const {
+        assert(t >= t0);
+        return static_cast<unsigned int>((t - t0) / resolution_ + 0.5);
+    }
+
+private:
+    static void put_varint(unsigned int v, std::vector<unsigned char>& out){
+        while(v >= 0x80){
+            out.push_back(static_cast<unsigned char>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(v));
+    }
+
+    static void put_raw(const void* p, size_t n, std::vector<unsigned char>& out){
+        const unsigned char* c = static_cast<const unsigned char*>(p);
+        out.insert(out.end(), c, c + n);
+    }
+
+    double resolution_;
+};
+
+/**
+    \brief compact_reader walks a buffer of concatenated compact segments
+    (as received from the allgatherv) and returns one spike per call.
+ */
+class compact_reader {
+public:
+    /** \fn compact_reader(const unsigned char* first, const unsigned char* last, double resolution)
+     *  \brief creates a reader over [first, last)
+     */
+    compact_reader(const unsigned char* first, const unsigned char* last, double resolution = 1.):
+    pos_(first), end_(last), resolution_(resolution), remaining_(0), width_(0), t0_(0.), gid_(0){}
+
+    /** \fn bool next(queueing::event& e)
+     *  \brief decodes the next spike
+     *  \param e is assigned to the decoded spike
+     *  \return false once the buffer is exhausted
+     */
+    bool next(queueing::event& e){
+        while(remaining_ == 0){
+            if(pos_ >= end_)
+                return false;
+            remaining_ = get_varint();
+            width_ = *pos_++;
+            memcpy(&t0_, pos_, sizeof(double));
+            pos_ += sizeof(double);
+            gid_ = 0;
+        }
+        gid_ += get_varint();
+        unsigned int off;
+        if(width_ == 2){
+            unsigned short s;
+            memcpy(&s, pos_, sizeof(s));
+            off = s;
+        }
+        else{
+            memcpy(&off, pos_, sizeof(off));
+        }
+        pos_ += width_;
+        --remaining_;
+
+        e.data_ = static_cast<int>(gid_);
+        e.t_ = t0_ + off * resolution_;
+        return true;
+    }
+
+private:
+    unsigned int get_varint(){
+        unsigned int v = 0;
+        int shift = 0;
+        while(*pos_ & 0x80){
+            v |= static_cast<unsigned int>(*pos_++ & 0x7f) << shift;
+            shift += 7;
+        }
+        v |= static_cast<unsigned int>(*pos_++) << shift;
+        return v;
+    }
+
+    const unsigned char* pos_;
+    const unsigned char* end_;
+    double resolution_;
+    unsigned int remaining_;
+    unsigned char width_;
+    double t0_;
+    unsigned int gid_;
+};
+
+} //end of namespace
+
+#endif
@@ -0,0 +1,221 @@
+/*
+ * Neuromapp - hierarchical.hpp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/spike/hierarchical.hpp
+ * contains the node level (two level) spike exchange: the ranks of a
+ * node share one copy of the global spike list
+ */
+
+#ifndef MAPP_HIERARCHICAL_H
+#define MAPP_HIERARCHICAL_H
+
+#include <assert.h>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <mpi.h>
+
+#include "coreneuron_1.0/event_passing/queueing/queue.h"
+#include "coreneuron_1.0/event_passing/spike/algos.hpp"
+
+/**
+    \brief communicators and shared memory window of the node level exchange.
+    The window, allocated by the node leader (node rank 0), holds the spikes
+    of all the ranks, every rank of the node reads them in place.
+ */
+struct node_window{
+    MPI_Comm node_;          // ranks sharing the memory of the node
+    MPI_Comm leaders_;       // the node leaders, MPI_COMM_NULL on the other ranks
+    MPI_Win win_;
+    queueing::event* base_;  // start of the window (leader memory)
+    int capacity_;           // number of spikes the window can hold
+    int node_rank_;
+    int node_size_;
+    std::vector<int> nlocal_;      // spikes of every rank of the node
+    std::vector<int> nnode_;       // leader: spikes of every node
+    std::vector<int> node_displ_;  // leader: displacement of every node
+};
+
+#if MPI_VERSION >= 3
+/**
+ * \fn allocate_node_window(node_window& w, int capacity)
+ * \brief (re)allocates the shared window of the node for capacity spikes,
+ * collective over w.node_. The window stays in a passive (lock_all) epoch
+ * until it is freed.
+ */
+inline void allocate_node_window(node_window& w, int capacity){
+    if(w.win_ != MPI_WIN_NULL){
+        MPI_Win_unlock_all(w.win_);
+        MPI_Win_free(&w.win_);
+    }
+    MPI_Aint bytes = w.node_rank_ == 0 ?
+        static_cast<MPI_Aint>(capacity) * sizeof(queueing::event) : 0;
+    void* mine;
+    MPI_Win_allocate_shared(bytes, sizeof(queueing::event), MPI_INFO_NULL,
+        w.node_, &mine, &w.win_);
+    MPI_Aint size;
+    int disp;
+    MPI_Win_shared_query(w.win_, 0, &size, &disp, &w.base_);
+    w.capacity_ = capacity;
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, w.win_);
+}
+
+/**
+ * \fn create_node_window(int ranks_per_node)
+ * \brief splits MPI_COMM_WORLD into nodes (MPI_COMM_TYPE_SHARED) and
+ * creates the communicator of the node leaders
+ * \param ranks_per_node if > 0, a node is further split into groups of at
+ * most ranks_per_node ranks (to emulate several nodes on one machine)
+ */
+inline node_window create_node_window(int ranks_per_node = 0){
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    node_window w;
+    w.win_ = MPI_WIN_NULL;
+    w.base_ = NULL;
+    w.capacity_ = 0;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+        MPI_INFO_NULL, &w.node_);
+    if(ranks_per_node > 0){
+        MPI_Comm shared = w.node_;
+        int shared_rank;
+        MPI_Comm_rank(shared, &shared_rank);
+        MPI_Comm_split(shared, shared_rank / ranks_per_node, shared_rank, &w.node_);
+        MPI_Comm_free(&shared);
+    }
+    MPI_Comm_rank(w.node_, &w.node_rank_);
+    MPI_Comm_size(w.node_, &w.node_size_);
+    MPI_Comm_split(MPI_COMM_WORLD, w.node_rank_ == 0 ? 0 : MPI_UNDEFINED,
+        rank, &w.leaders_);
+    w.nlocal_.resize(w.node_size_);
+    if(w.node_rank_ == 0){
+        int nnodes;
+        MPI_Comm_size(w.leaders_, &nnodes);
+        w.nnode_.resize(nnodes);
+        w.node_displ_.resize(nnodes);
+    }
+    allocate_node_window(w, 1024);
+    return w;
+}
+
+/**
+ * \fn free_node_window(node_window& w)
+ * \brief frees the window and the communicators
+ */
+inline void free_node_window(node_window& w){
+    MPI_Win_unlock_all(w.win_);
+    MPI_Win_free(&w.win_);
+    if(w.leaders_ != MPI_COMM_NULL)
+        MPI_Comm_free(&w.leaders_);
+    MPI_Comm_free(&w.node_);
+}
+
+//SIMULATIONS
+/**
+ * \fn hierarchical_spike(data& d, MPI_Datatype spike, node_window& w)
+ * \brief performs a two level spike exchange:
+ *  - the ranks of a node share their spike counts (MPI_Allgather on w.node_)
+ *  - the leaders exchange the node counts and broadcast the total and the
+ *    displacement of their node
+ *  - every rank copies its spikes at its place in the shared window
+ *  - the leaders perform the in place MPI_Allgatherv between the nodes
+ *  - every rank reads the global spike list in place (d.spikein_shared_)
+ * Only the leaders send and receive over the network: the bytes are
+ * counted on the leaders only.
+ * \param d the data environment on which this algo is called
+ * \param spike the MPI_Datatype being communicated
+ * \param w the node window, from create_node_window
+ */
+template<typename data>
+void hierarchical_spike(data& d, MPI_Datatype spike, node_window& w){
+    int type_size;
+    MPI_Type_size(spike, &type_size);
+    double t0 = MPI_Wtime();
+
+    //also guarantees that every rank is done reading the previous exchange
+    int send_size = d.spikeout_.size();
+    MPI_Allgather(&send_size, 1, MPI_INT, &w.nlocal_[0], 1, MPI_INT, w.node_);
+
+    //header[0]: total number of spikes, header[1]: displacement of the node
+    int header[2] = {0, 0};
+    int node_size = 0;
+    if(w.node_rank_ == 0){
+        for(int i = 0; i < w.node_size_; ++i)
+            node_size += w.nlocal_[i];
+        MPI_Allgather(&node_size, 1, MPI_INT, &w.nnode_[0], 1, MPI_INT, w.leaders_);
+        int rank;
+        MPI_Comm_rank(w.leaders_, &rank);
+        for(int i = 0; i < w.nnode_.size(); ++i){
+            w.node_displ_[i] = header[0];
+            header[0] += w.nnode_[i];
+        }
+        header[1] = w.node_displ_[rank];
+    }
+    MPI_Bcast(header, 2, MPI_INT, 0, w.node_);
+
+    if(header[0] > w.capacity_)
+        allocate_node_window(w, std::max(header[0], 2 * w.capacity_));
+
+    int displ = header[1];
+    for(int i = 0; i < w.node_rank_; ++i)
+        displ += w.nlocal_[i];
+    if(send_size > 0)
+        std::copy(d.spikeout_.begin(), d.spikeout_.end(), w.base_ + displ);
+    MPI_Win_sync(w.win_);
+    MPI_Barrier(w.node_);
+
+    if(w.node_rank_ == 0){
+        MPI_Win_sync(w.win_);
+        MPI_Allgatherv(MPI_IN_PLACE, 0, spike, w.base_, &w.nnode_[0],
+            &w.node_displ_[0], spike, w.leaders_);
+        MPI_Win_sync(w.win_);
+        d.bytes_sent_stats_ += static_cast<double>(node_size) * type_size;
+        d.bytes_received_stats_ += static_cast<double>(header[0] - node_size) * type_size;
+    }
+    MPI_Barrier(w.node_);
+    MPI_Win_sync(w.win_);
+
+    d.spikein_shared_ = w.base_;
+    d.nshared_ = header[0];
+    d.exchange_time_stats_ += MPI_Wtime() - t0;
+    ++d.exchange_stats_;
+}
+#else
+inline node_window create_node_window(int ranks_per_node = 0){
+    std::cerr<<"MPI version is < 3. Cannot use hierarchical implementation"<<std::endl;
+    exit(EXIT_FAILURE);
+}
+
+inline void free_node_window(node_window& w){
+    std::cerr<<"MPI version is < 3. Cannot use hierarchical implementation"<<std::endl;
+    exit(EXIT_FAILURE);
+}
+
+template<typename data>
+void hierarchical_spike(data& d, MPI_Datatype spike, node_window& w){
+    std::cerr<<"MPI version is < 3. Cannot use hierarchical implementation"<<std::endl;
+    exit(EXIT_FAILURE);
+}
+#endif //MPI VERSION 3
+
+#endif
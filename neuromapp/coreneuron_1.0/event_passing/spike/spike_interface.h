@@ -31,6 +31,7 @@
 #include <fstream>
 
 #include "utils/omp/lock.h"
+#include "coreneuron_1.0/event_passing/spike/encoding.h"
 
 namespace spike {
 
@@ -48,23 +49,59 @@ struct spike_interface{
     std::vector<int> nin_;
     std::vector<int> displ_;
 
+    //COMPACT ENCODING (used by the compact_* exchange algos)
+    compact_codec codec_;
+    std::vector<unsigned char> bytesout_;
+    std::vector<unsigned char> bytesin_;
+
+    //NODE LEVEL EXCHANGE (hierarchical_spike): the received spikes are
+    //read in place from the shared window of the node
+    const queueing::event* spikein_shared_;
+    int nshared_;
+
     //STATS ACCUMULATORS
     int spike_stats_;
     int ite_stats_;
     int local_stats_;
     int post_spike_stats_;
     int received_spike_stats_;
+    double bytes_sent_stats_;
+    double bytes_received_stats_;
+    double exchange_time_stats_;
+    int exchange_stats_;
+    //load of the threads per min delay interval (filled by the pool)
+    double imbalance_stats_;
+    double p99_imbalance_stats_;
+    double max_imbalance_stats_;
+    double idle_stats_;
+    int interval_stats_;
+    //events delivered from the queues and time spent (filled by the pool)
+    int delivered_stats_;
+    double deliver_time_stats_;
 
     /** \fn spike_interface(int nprocs)
         \brief spike_interface constructor. Initializes nin and displ buffers
         to have size == number of processes
      */
     spike_interface(int nprocs):
+        spikein_shared_(NULL),
+        nshared_(0),
         spike_stats_(0),
         ite_stats_(0),
         local_stats_(0),
         post_spike_stats_(0),
-        received_spike_stats_(0)
+        received_spike_stats_(0),
+        bytes_sent_stats_(0.),
+        bytes_received_stats_(0.),
+        exchange_time_stats_(0.),
+        exchange_stats_(0),
+        imbalance_stats_(0.),
+        p99_imbalance_stats_(0.),
+        max_imbalance_stats_(0.),
+        idle_stats_(0.),
+        interval_stats_(0),
+        delivered_stats_(0),
+        deliver_time_stats_(0.)
         {nin_.resize(nprocs); displ_.resize(nprocs);}
 };
 
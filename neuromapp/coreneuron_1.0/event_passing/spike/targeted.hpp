@@ -0,0 +1,165 @@
+/*
+ * Neuromapp - targeted.hpp, Copyright (c), 2015,
+ * Kai Langen - Swiss Federal Institute of technology in Lausanne,
+ * kai.langen@epfl.ch,
+ * All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/event_passing/spike/targeted.hpp
+ * contains the targeted spike exchange: a spike is only sent to the
+ * ranks having an input presyn for its gid
+ */
+
+#ifndef MAPP_TARGETED_H
+#define MAPP_TARGETED_H
+
+#include <assert.h>
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <mpi.h>
+
+#include "coreneuron_1.0/event_passing/queueing/queue.h"
+#include "coreneuron_1.0/event_passing/environment/presyn_table.h"
+#include "coreneuron_1.0/event_passing/environment/neurondistribution.h"
+#include "coreneuron_1.0/event_passing/spike/algos.hpp"
+
+/**
+    \brief destination ranks of the local gids and the send buffers
+    of the targeted exchange
+ */
+struct spike_targets{
+    environment::presyn_table ranks_;   // local gid -> ranks with an input presyn
+    std::vector<int> nout_;             // spikes sent to every rank
+    std::vector<int> sdispl_;
+    std::vector<int> fill_;
+    std::vector<spike_item> sendbuf_;   // spikeout_ bucketed by destination
+};
+
+/**
+ * \fn create_spike_targets(P& presyns, int ncells)
+ * \brief builds the destination ranks of every local gid, once, from the
+ * input presyns of all the ranks.
+ *
+ *Summary:
+ * - The owner of an input gid follows from the continous distribution of
+ *   the ncells cells over the ranks (no global list of the gids).
+ *
+ * - Every rank asks the owners of its input gids (MPI_Alltoall of the
+ *   counts, MPI_Alltoallv of the gids).
+ *
+ * - The requests received become the rows of ranks_.
+ * \param ncells the total number of cells in the simulation
+ */
+template <typename P>
+spike_targets create_spike_targets(const P& presyns, int ncells){
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    //requests for the input gids, sorted so grouped by owner
+    std::vector<int> requests;
+    presyns.input_gids(requests);
+    std::vector<int> nrequests(size, 0);
+    for(int i = 0; i < requests.size(); ++i)
+        nrequests[environment::continousdistribution::owner(requests[i], size, ncells)]++;
+
+    std::vector<int> nasked(size), sdispl(size), rdispl(size);
+    MPI_Alltoall(&nrequests[0], 1, MPI_INT, &nasked[0], 1, MPI_INT, MPI_COMM_WORLD);
+    int nask = 0;
+    int nreq = 0;
+    for(int i = 0; i < size; ++i){
+        sdispl[i] = nreq;
+        nreq += nrequests[i];
+        rdispl[i] = nask;
+        nask += nasked[i];
+    }
+    std::vector<int> asked(nask + 1);
+    requests.push_back(0);
+    MPI_Alltoallv(&requests[0], &nrequests[0], &sdispl[0], MPI_INT,
+        &asked[0], &nasked[0], &rdispl[0], MPI_INT, MPI_COMM_WORLD);
+
+    std::map<int, std::vector<int> > ranks;
+    for(int r = 0; r < size; ++r){
+        for(int i = rdispl[r]; i < rdispl[r] + nasked[r]; ++i)
+            ranks[asked[i]].push_back(r);
+    }
+
+    spike_targets t;
+    t.ranks_.build(ranks);
+    t.nout_.resize(size);
+    t.sdispl_.resize(size);
+    t.fill_.resize(size);
+    return t;
+}
+
+//SIMULATIONS
+/**
+ * \fn targeted_spike(data& d, MPI_Datatype spike, spike_targets& t)
+ * \brief performs a spike exchange where every spike is only sent to the
+ * ranks having an input presyn for its gid: spikeout_ is bucketed by
+ * destination, MPI_Alltoall exchanges the counts and MPI_Alltoallv the
+ * spikes. The received spikes are in spikein_, as with blocking_spike.
+ * \param d the data environment on which this algo is called
+ * \param spike the MPI_Datatype being communicated
+ * \param t the destination ranks, from create_spike_targets
+ */
+template<typename data>
+void targeted_spike(data& d, MPI_Datatype spike, spike_targets& t){
+    int type_size;
+    MPI_Type_size(spike, &type_size);
+    double t0 = MPI_Wtime();
+
+    //bucket the spikes by destination
+    std::fill(t.nout_.begin(), t.nout_.end(), 0);
+    for(int i = 0; i < d.spikeout_.size(); ++i){
+        const environment::presyn* ranks = t.ranks_.find(d.spikeout_[i].data_);
+        if(ranks == NULL)
+            continue;
+        for(int j = 0; j < ranks->size(); ++j)
+            t.nout_[(*ranks)[j]]++;
+    }
+    int nsend = 0;
+    for(int i = 0; i < t.nout_.size(); ++i){
+        t.sdispl_[i] = nsend;
+        nsend += t.nout_[i];
+    }
+    t.sendbuf_.resize(nsend + 1);
+    std::copy(t.sdispl_.begin(), t.sdispl_.end(), t.fill_.begin());
+    for(int i = 0; i < d.spikeout_.size(); ++i){
+        const environment::presyn* ranks = t.ranks_.find(d.spikeout_[i].data_);
+        if(ranks == NULL)
+            continue;
+        for(int j = 0; j < ranks->size(); ++j)
+            t.sendbuf_[t.fill_[(*ranks)[j]]++] = d.spikeout_[i];
+    }
+
+    MPI_Alltoall(&t.nout_[0], 1, MPI_INT, &d.nin_[0], 1, MPI_INT, MPI_COMM_WORLD);
+    set_displ(d);
+    const int nrecv = d.spikein_.size();
+    d.spikein_.resize(nrecv + 1);
+    MPI_Alltoallv(&t.sendbuf_[0], &t.nout_[0], &t.sdispl_[0], spike,
+        &d.spikein_[0], &d.nin_[0], &d.displ_[0], spike, MPI_COMM_WORLD);
+    d.spikein_.resize(nrecv);
+
+    d.exchange_time_stats_ += MPI_Wtime() - t0;
+    ++d.exchange_stats_;
+    d.bytes_sent_stats_ += static_cast<double>(nsend) * type_size;
+    d.bytes_received_stats_ += static_cast<double>(nrecv) * type_size;
+}
+
+#endif
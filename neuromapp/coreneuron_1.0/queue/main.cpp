@@ -33,6 +33,7 @@
 #include "coreneuron_1.0/queue/tool/priority_queue.hpp"
 #include "coreneuron_1.0/queue/trait.h"
 #include "coreneuron_1.0/queue/serial_benchmark.h"
+#include "coreneuron_1.0/queue/trace_benchmark.h"
 
 /** namespace alias for boost::program_options **/
 namespace po = boost::program_options;
@@ -50,7 +51,8 @@ int queue_help(int argc, char* const argv[], po::variables_map& vm){
     ("help", "produce help message")
     ("benchmark", po::value<std::string>()->default_value("push"), "push, pop, push_one, mh_bench or all")
     ("size", po::value<int>()->default_value(10), "bench = 2^size")
-    ("io", po::value<bool>()->default_value(false), "save $benchmark results IO i.e. pop.csv");
+    ("io", po::value<bool>()->default_value(false), "save $benchmark results IO i.e. pop.csv")
+    ("trace", po::value<std::string>(), "replay this trace (recorded by the event_passing miniapp) on every queue instead of $benchmark");
 
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
@@ -67,13 +69,16 @@ template<class T>
 void benchmark(int iteration, bool io){
     int size(1);
     std::list<std::string> res;
-    res.push_back("#elements,std::priority_queue,sptq_queue,bin_queue,boost::binomial_heap,boost::fibonacci_heap,boost::skew_heap,boost::pairing_heap \n");
+    res.push_back("#elements,std::priority_queue,sptq_queue,bin_queue,sptq_queue_pool,bin_queue_pool,calendar_queue,boost::binomial_heap,boost::fibonacci_heap,boost::skew_heap,boost::d_ary_heap \n");
 
     for(int i=1; i< iteration; ++i){
         std::string bench = boost::lexical_cast<std::string>(size) + ",";
-        bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<priority_queue> >(size));
+        bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<priority_queue> >(size)) + ",";
         bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<sptq_queue> >(size)) + ",";
         bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<bin_queue> >(size)) + ",";
+        bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<sptq_queue_pool> >(size)) + ",";
+        bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<bin_queue_pool> >(size)) + ",";
+        bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<calendar_queue> >(size)) + ",";
         bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<binomial_heap> >(size)) + ",";
         bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<fibonacci_heap> >(size)) + ",";
         bench += boost::lexical_cast<std::string>(T::template benchmark<helper_type<skew_heap> >(size)) + ",";
@@ -91,6 +96,37 @@ void benchmark(int iteration, bool io){
 }
 
 
+/** \fn trace_benchmark(std::string const& name, bool io)
+ \brief replay a recorded trace on every queue, cycle histograms per operation
+ \return error message from mapp::mapp_error
+ */
+int trace_benchmark(std::string const& name, bool io){
+    std::vector<queue::trace> traces;
+    if(!queue::read_traces(name,traces))
+        return mapp::MAPP_BAD_DATA;
+
+    std::list<std::string> res;
+    res.push_back("#queue,operation,count,mean,p50,p99,log2 cycles histogram \n");
+    res.push_back(queue::trace_helper::benchmark<helper_type<priority_queue> >(traces));
+    res.push_back(queue::trace_helper::benchmark<helper_type<sptq_queue> >(traces));
+    res.push_back(queue::trace_helper::benchmark<helper_type<bin_queue> >(traces));
+    res.push_back(queue::trace_helper::benchmark<helper_type<sptq_queue_pool> >(traces));
+    res.push_back(queue::trace_helper::benchmark<helper_type<bin_queue_pool> >(traces));
+    res.push_back(queue::trace_helper::benchmark<helper_type<calendar_queue> >(traces));
+    res.push_back(queue::trace_helper::benchmark<helper_type<binomial_heap> >(traces));
+    res.push_back(queue::trace_helper::benchmark<helper_type<fibonacci_heap> >(traces));
+    res.push_back(queue::trace_helper::benchmark<helper_type<pairing_heap> >(traces));
+    res.push_back(queue::trace_helper::benchmark<helper_type<skew_heap> >(traces));
+    res.push_back(queue::trace_helper::benchmark<helper_type<d_ary_heap> >(traces));
+
+    std::copy(res.begin(),res.end(), std::ostream_iterator<std::string>(std::cout, "")); //screen
+    if(io){
+        std::ofstream out("trace.csv");
+        std::copy(res.begin(),res.end(), std::ostream_iterator<std::string>(out, ""));
+    }
+    return mapp::MAPP_OK;
+}
+
 /** \fn keyvalue_content(po::variables_map const& vm)
  \brief Execute the keyvalue benchmark
  \param vm encapsulate the command line and all needed informations
@@ -105,6 +141,9 @@ int queue_content(po::variables_map const& vm){
 
     bool io = vm["io"].as<bool>();
 
+    if(vm.count("trace"))
+        return trace_benchmark(vm["trace"].as<std::string>(),io);
+
     std::map<std::string,queue::benchs> m;
     m.insert(std::make_pair("push",queue::push));
     m.insert(std::make_pair("pop",queue::pop));
@@ -1,5 +1,6 @@
 
-
+#ifndef timer_asm_h
+#define timer_asm_h
 
 #if defined(__x86_64__)
     static __inline__ unsigned long long rdtsc(void){
@@ -25,4 +26,6 @@
         result = result|lower;
         return(result);
     }
-#endif
\ No newline at end of file
+#endif
+
+#endif
@@ -2,7 +2,10 @@
 #ifndef bin_queue_hpp_
 #define bin_queue_hpp_
 
-#include "coreneuron_1.0/queue/tool/bin_queue.hpp"
+#include <assert.h>
+#include <vector>
+
+#include "coreneuron_1.0/queue/tool/node_pool.hpp"
 
 namespace tool {
 
@@ -15,6 +18,8 @@ namespace tool {
     using the inverse of dt. Consequently, genericity with template is useless
 
     I remove the array and use a std::vector to have a safe resize
+
+    The nodes come from the Allocator policy (see node_pool.hpp), a pool by default
  */
  
      //node for the bin queue
@@ -27,12 +32,13 @@ namespace tool {
         int cnt_;
     };
 
-    template<class T>
+    template<class T, class Allocator = node_pool<bin_node<T> > >
     class bin_queue {
     public:
         typedef T value_type;
         typedef std::size_t size_type;
         typedef bin_node<value_type> node_type;
+        typedef Allocator allocator_type;
 
         inline explicit bin_queue(double dt = 0.025, value_type t0 = 0.):size_(0),qpt_(0),dt_(dt),tt_(t0)
                                                                              ,bins_(1024){}
@@ -41,12 +47,19 @@ namespace tool {
 
         /** std::priority_queue API like */
         inline void push(value_type t){
-            node_type* n = new node_type(t);
+            node_type* n = alloc_.create(t);
             enqueue(t,n); // t encapsulate in the bin_node but also needed for the "hash function"
             size_++;
         }
 
+        /** a node for push(node_type*), from the allocator of the queue */
+        inline node_type* create(value_type t){
+            return alloc_.create(t);
+        }
+
+        /** n from create() or find(), the queue releases it with its allocator */
         inline void push(node_type* n){
+            assert(alloc_.owns(n));
             enqueue(n->t_,n); // t encapsulate in the bin_node but also needed for the "hash function"
             size_++;
         }
@@ -55,7 +68,7 @@ namespace tool {
             if(!empty()){
                 node_type* q = first();
                 remove(q);
-                delete q;
+                alloc_.destroy(q);
                 size_--;
             }
         }
@@ -83,6 +96,10 @@ namespace tool {
             return n;
         }
 
+        /** pops all the elements <= til into out, bin after bin (unordered within a bin,
+         as pop): a bin entirely due is spliced at once, the last one is filtered */
+        size_type drain_until(value_type til, std::vector<value_type>& out);
+
     private:
         /** original API */
         inline void enqueue(value_type tt, tool::bin_node<value_type>*);
@@ -97,6 +114,7 @@ namespace tool {
         double dt_; // step times
         value_type tt_; // time at beginning of qpt_ interval
         std::vector<node_type*> bins_; // for correct resize
+        allocator_type alloc_; // gives and recycles the nodes
     };
 }
 
@@ -6,18 +6,18 @@
 
 namespace tool{
 
-    template<class T>
-    bin_queue<T>::~bin_queue() {
+    template<class T, class A>
+    bin_queue<T,A>::~bin_queue() {
         node_type* q, *q2;
         for (q = first(); q; q = q2) {
             q2 = next(q);
             remove(q); /// Potentially dereferences freed pointer this->sptree_
-            delete q;
+            alloc_.destroy(q);
         }
     }
 
-    template<class T>
-    void bin_queue<T>::enqueue(T td, node_type* q) {
+    template<class T, class A>
+    void bin_queue<T,A>::enqueue(T td, node_type* q) {
 
         int rev_dt = 1/dt_;
         int idt = (int)((td - tt_)*rev_dt + 1.e-10);
@@ -31,8 +31,8 @@ namespace tool{
         bins_[idt] = q;
     }
 
-    template<class T>
-    typename bin_queue<T>::node_type* bin_queue<T>::first() {
+    template<class T, class A>
+    typename bin_queue<T,A>::node_type* bin_queue<T,A>::first() {
         for (int i = qpt_; i < bins_.size(); ++i) {
             if (bins_[i]) {
                 qpt_ = i; // keep track of the first bin
@@ -42,8 +42,8 @@ namespace tool{
         return 0;
     }
 
-    template<class T>
-    typename bin_queue<T>::node_type* bin_queue<T>::next(node_type* q) {
+    template<class T, class A>
+    typename bin_queue<T,A>::node_type* bin_queue<T,A>::next(node_type* q) {
         if (q->left_) { return q->left_; }
         for (int i = q->cnt_ + 1; i < bins_.size(); ++i) {
             if (bins_[i]) {
@@ -53,8 +53,45 @@ namespace tool{
         return 0;
     }
 
-    template<class T>
-    void bin_queue<T>::remove(node_type* q) {
+    template<class T, class A>
+    typename bin_queue<T,A>::size_type bin_queue<T,A>::drain_until(T til, std::vector<T>& out) {
+        size_type n = 0;
+        if (!first())
+            return n;
+        int rev_dt = 1/dt_; // same bins as enqueue
+        for (int i = qpt_; i < bins_.size() && tt_ + (double)i/rev_dt <= til; ++i) {
+            node_type* q = bins_[i];
+            if (!q)
+                continue;
+            if (tt_ + (double)(i+1)/rev_dt <= til) { // the whole bin is due
+                bins_[i] = 0;
+                for (node_type* q2; q; q = q2) {
+                    q2 = q->left_;
+                    out.push_back(q->t_);
+                    alloc_.destroy(q);
+                    ++n;
+                }
+                continue;
+            }
+            node_type** p = &bins_[i];
+            while (*p) {
+                q = *p;
+                if (q->t_ <= til) {
+                    *p = q->left_;
+                    out.push_back(q->t_);
+                    alloc_.destroy(q);
+                    ++n;
+                } else {
+                    p = &q->left_;
+                }
+            }
+        }
+        size_ -= n;
+        return n;
+    }
+
+    template<class T, class A>
+    void bin_queue<T,A>::remove(node_type* q) {
         node_type* q1, *q2;
         q1 = bins_[q->cnt_];
         if (q1 == q) {
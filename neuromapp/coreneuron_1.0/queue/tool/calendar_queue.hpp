@@ -0,0 +1,136 @@
+
+#ifndef calendar_queue_hpp_
+#define calendar_queue_hpp_
+
+#include <assert.h>
+#include <vector>
+#include <utility>
+
+namespace tool {
+
+/** the calendar queue is a timing wheel: a ring of nbins buckets of width dt, the bucket of an
+    element is (t - t0)/dt modulo nbins. The wheel only holds the elements of the next nbins*dt
+    time units (one "year") after the cursor, later elements wait in an overflow heap and are
+    moved into the wheel when the cursor reaches their year.
+
+    Spike delivery times are bounded (min_delay to max_delay after the current time) and
+    quantized by dt so, with a wheel covering max_delay, push and pop are O(1): no comparison
+    between elements except inside a bucket. A bucket is an unsorted single link list (using
+    the "left" link) until the cursor reaches it, it is then sorted once and later insertions
+    into it are sorted: contrary to the bin_queue top() is exact for any value and not only up
+    to dt.
+
+    top() moves the cursor to the bucket of the smallest element. An element earlier than the
+    cursor moves it back, the buckets which leave the year return to the overflow, it costs the
+    slots the cursor went back, paid by the slots it went forward.
+ */
+
+    //node for the calendar queue
+    template<class T>
+    struct calendar_node {
+        typedef T value_type;
+        explicit calendar_node(value_type t = value_type()):t_(t),left_(0),bin_(-1){};
+        value_type t_;
+        calendar_node* left_;
+        int bin_; // bucket of the node, -1 if in the overflow heap
+    };
+
+    template<class T>
+    class calendar_queue {
+    public:
+        typedef T value_type;
+        typedef std::size_t size_type;
+        typedef calendar_node<value_type> node_type;
+
+        /** nbins is rounded up to a power of 2 */
+        inline explicit calendar_queue(double dt = 0.025, value_type t0 = 0., int nbins = 1024)
+        :size_(0),wheel_size_(0),cur_(0),cur_sorted_(false),rdt_(1./dt),t0_(t0){
+            int n = 1;
+            while(n < nbins)
+                n <<= 1;
+            bins_.resize(n,0);
+            mask_ = n - 1;
+        }
+
+        ~calendar_queue();
+
+        /** std::priority_queue API like */
+        inline void push(value_type t){
+            node_type* n = new node_type(t);
+            enqueue(n);
+            size_++;
+        }
+
+        /** a node for push(node_type*), deleted by the queue */
+        inline node_type* create(value_type t){
+            return new node_type(t);
+        }
+
+        inline void push(node_type* n){
+            enqueue(n);
+            size_++;
+        }
+
+        inline void pop(){
+            if(!empty()){
+                node_type* q = first();
+                bins_[q->bin_] = q->left_;
+                wheel_size_--;
+                delete q;
+                size_--;
+            }
+        }
+
+        /* the top corresponds to the smallest element, as std::priority_queue with
+         the greater comparator */
+        inline value_type top(){
+            value_type r = value_type();
+            if(!empty())
+                r = first()->t_;
+            return r;
+        }
+
+        inline size_type size(){
+            return size_;
+        }
+
+        inline bool empty(){
+            return !bool(size_);
+        }
+
+        inline node_type* find(node_type* n){
+            remove(n);
+            size_--; // WARNING remove the node but do not delete it
+            return n;
+        }
+
+        /** pops all the elements <= til into out, in order: the due prefix of the
+         sorted bucket of the cursor is spliced at once, bucket after bucket */
+        size_type drain_until(value_type til, std::vector<value_type>& out);
+
+    private:
+        /** absolute slot number of t */
+        inline long long slot(value_type t) const;
+
+        void enqueue(node_type* n);
+        void insert_bin(node_type* n, int bin);
+        void refill();
+        void rewind(long long k);
+        void sort_bin(int bin);
+        node_type* first();
+        void remove(node_type* n);
+
+        size_type size_;
+        size_type wheel_size_; // number of elements into the buckets
+        long long cur_; // slot of the cursor
+        bool cur_sorted_; // the bucket of the cursor is sorted
+        int mask_;
+        double rdt_; // 1/dt
+        value_type t0_; // time of slot 0
+        std::vector<node_type*> bins_;
+        std::vector<node_type*> overflow_; // min-heap on t_
+        std::vector<std::pair<value_type, node_type*> > scratch_; // buffer of sort_bin
+    };
+}
+
+#endif
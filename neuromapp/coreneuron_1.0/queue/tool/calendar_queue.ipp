@@ -0,0 +1,193 @@
+
+#ifndef calendar_queue_ipp_
+#define calendar_queue_ipp_
+
+#include <cmath>
+#include <algorithm>
+
+namespace tool{
+
+    /** heap order of the overflow, smallest time on top */
+    template<class T>
+    struct calendar_node_later {
+        bool operator()(const calendar_node<T>* a, const calendar_node<T>* b) const {
+            return a->t_ > b->t_;
+        }
+    };
+
+    /** descending order of the keys of sort_bin */
+    template<class T>
+    struct calendar_key_later {
+        bool operator()(const std::pair<T, calendar_node<T>*>& a,
+                        const std::pair<T, calendar_node<T>*>& b) const {
+            return a.first > b.first;
+        }
+    };
+
+    template<class T>
+    calendar_queue<T>::~calendar_queue() {
+        node_type* q, *q2;
+        for (int i = 0; i < bins_.size(); ++i) {
+            for (q = bins_[i]; q; q = q2) {
+                q2 = q->left_;
+                delete q;
+            }
+        }
+        for (int i = 0; i < overflow_.size(); ++i)
+            delete overflow_[i];
+    }
+
+    template<class T>
+    long long calendar_queue<T>::slot(T t) const {
+        return (long long)std::floor((t - t0_)*rdt_ + 1.e-10);
+    }
+
+    template<class T>
+    void calendar_queue<T>::enqueue(node_type* n) {
+        long long k = slot(n->t_);
+        if (k > cur_ + mask_) { // beyond the current year
+            n->bin_ = -1;
+            n->left_ = 0;
+            overflow_.push_back(n);
+            std::push_heap(overflow_.begin(), overflow_.end(), calendar_node_later<T>());
+            return;
+        }
+        if (k < cur_)
+            rewind(k); // earlier than the cursor (top() moved it to the next element)
+        insert_bin(n, (int)(k & mask_));
+        wheel_size_++;
+    }
+
+    template<class T>
+    void calendar_queue<T>::insert_bin(node_type* n, int bin) {
+        n->bin_ = bin;
+        node_type** q = &bins_[bin];
+        if (cur_sorted_ && bin == (int)(cur_ & mask_)) {
+            while (*q && (*q)->t_ < n->t_) // before the equal times, O(1) if quantized
+                q = &(*q)->left_;
+        }
+        n->left_ = *q;
+        *q = n;
+    }
+
+    template<class T>
+    void calendar_queue<T>::sort_bin(int bin) {
+        node_type* q = bins_[bin];
+        while (q && q->left_ && !(q->left_->t_ < q->t_))
+            q = q->left_;
+        if (!q || !q->left_)
+            return; // already sorted, e.g. all the times of the bucket are quantized to dt
+
+        scratch_.clear();
+        for (q = bins_[bin]; q; q = q->left_)
+            scratch_.push_back(std::make_pair(q->t_, q)); // keys next to each other for the sort
+        std::sort(scratch_.begin(), scratch_.end(), calendar_key_later<T>());
+        node_type* head = 0;
+        for (int i = 0; i < scratch_.size(); ++i) { // from the largest to the smallest
+            scratch_[i].second->left_ = head;
+            head = scratch_[i].second;
+        }
+        bins_[bin] = head;
+    }
+
+    template<class T>
+    void calendar_queue<T>::rewind(long long k) {
+        // the slots beyond the new year go back to the overflow
+        const long long last = std::max(k + mask_, cur_ - 1);
+        for (long long s = cur_ + mask_; s > last; --s) {
+            node_type* q = bins_[s & mask_];
+            bins_[s & mask_] = 0;
+            while (q) {
+                node_type* q2 = q->left_;
+                q->bin_ = -1;
+                q->left_ = 0;
+                overflow_.push_back(q);
+                std::push_heap(overflow_.begin(), overflow_.end(), calendar_node_later<T>());
+                wheel_size_--;
+                q = q2;
+            }
+        }
+        cur_ = k;
+        cur_sorted_ = false;
+    }
+
+    template<class T>
+    void calendar_queue<T>::refill() {
+        while (!overflow_.empty() && slot(overflow_.front()->t_) <= cur_ + mask_) {
+            std::pop_heap(overflow_.begin(), overflow_.end(), calendar_node_later<T>());
+            node_type* n = overflow_.back();
+            overflow_.pop_back();
+            enqueue(n);
+        }
+    }
+
+    template<class T>
+    typename calendar_queue<T>::node_type* calendar_queue<T>::first() {
+        assert(size_ > 0);
+        if (wheel_size_ == 0) { // jump to the year of the next element
+            long long k = slot(overflow_.front()->t_);
+            if (k > cur_) {
+                cur_ = k;
+                cur_sorted_ = false;
+            }
+            refill();
+        }
+        while (!bins_[cur_ & mask_]) {
+            ++cur_;
+            cur_sorted_ = false;
+            refill();
+        }
+        if (!cur_sorted_) {
+            sort_bin((int)(cur_ & mask_));
+            cur_sorted_ = true;
+        }
+        return bins_[cur_ & mask_];
+    }
+
+    template<class T>
+    typename calendar_queue<T>::size_type calendar_queue<T>::drain_until(T til, std::vector<T>& out) {
+        size_type n = 0;
+        while (size_ && first()->t_ <= til) {
+            // first() sorted the bucket of the cursor, cut it after the last due node
+            const int bin = (int)(cur_ & mask_);
+            node_type* q = bins_[bin];
+            node_type* last = q;
+            size_type k = 1;
+            while (last->left_ && last->left_->t_ <= til) {
+                last = last->left_;
+                ++k;
+            }
+            bins_[bin] = last->left_;
+            last->left_ = 0;
+            wheel_size_ -= k;
+            size_ -= k;
+            n += k;
+            for (node_type* q2; q; q = q2) {
+                q2 = q->left_;
+                out.push_back(q->t_);
+                delete q;
+            }
+        }
+        return n;
+    }
+
+    template<class T>
+    void calendar_queue<T>::remove(node_type* n) {
+        if (n->bin_ < 0) {
+            typename std::vector<node_type*>::iterator it = std::find(overflow_.begin(), overflow_.end(), n);
+            assert(it != overflow_.end());
+            *it = overflow_.back();
+            overflow_.pop_back();
+            std::make_heap(overflow_.begin(), overflow_.end(), calendar_node_later<T>());
+            return;
+        }
+        node_type** q = &bins_[n->bin_];
+        while (*q != n)
+            q = &(*q)->left_;
+        *q = n->left_;
+        n->left_ = 0;
+        wheel_size_--;
+    }
+}
+
+#endif
@@ -0,0 +1,108 @@
+
+#ifndef node_pool_hpp_
+#define node_pool_hpp_
+
+#include <new>
+#include <vector>
+
+namespace tool {
+
+/** Allocator policies of the node based queues (bin_queue, sptq_queue). A policy gives
+    create(value) for a new node and destroy(node) when pop() (or the destructor of the
+    queue) releases it.
+
+    new_allocator is the original behaviour: one new/delete per node.
+
+    node_pool allocates the nodes by chunks of contiguous nodes and keeps the released nodes
+    into a free list (a single link list written into the released nodes themselves), a
+    push after a pop reuses the last released node which is still in cache. The memory
+    goes back to the system only when the pool (so the queue) is destroyed.
+
+    The nodes given to the queue by push(node_type*) are released with the allocator of the
+    queue, so they must come from the queue itself: create(value) of the queue, or a node
+    taken out by find() (tool::move). A pool only frees its own chunks, owns() checks it
+    (assert of push).
+ */
+
+    template<class Node>
+    struct new_allocator {
+        typedef Node node_type;
+        typedef typename Node::value_type value_type;
+
+        inline node_type* create(value_type t){
+            return new node_type(t);
+        }
+
+        inline void destroy(node_type* n){
+            delete n;
+        }
+
+        inline bool owns(const node_type*) const{
+            return true;
+        }
+    };
+
+    template<class Node>
+    class node_pool {
+    public:
+        typedef Node node_type;
+        typedef typename Node::value_type value_type;
+
+        /** chunk_size nodes per allocation, by default about a page of nodes */
+        inline explicit node_pool(std::size_t chunk_size = 4096/sizeof(Node))
+        :chunk_size_(chunk_size > 16 ? chunk_size : 16),free_(0){}
+
+        ~node_pool(){
+            for(std::size_t i = 0; i < chunks_.size(); ++i)
+                ::operator delete(chunks_[i]);
+        }
+
+        inline node_type* create(value_type t){
+            if(!free_)
+                grow();
+            void* p = free_;
+            free_ = *static_cast<void**>(free_);
+            return new(p) node_type(t);
+        }
+
+        inline void destroy(node_type* n){
+            n->~node_type();
+            *reinterpret_cast<void**>(n) = free_;
+            free_ = n;
+        }
+
+        /** true if n is in a chunk of the pool, linear in the number of chunks (asserts) */
+        bool owns(const node_type* n) const{
+            for(std::size_t i = 0; i < chunks_.size(); ++i)
+                if(n >= chunks_[i] && n < chunks_[i] + chunk_size_)
+                    return true;
+            return false;
+        }
+
+        /** number of nodes allocated from the system */
+        inline std::size_t capacity() const {
+            return chunks_.size()*chunk_size_;
+        }
+
+    private:
+        /** no copy, the free list points into the chunks */
+        node_pool(const node_pool&);
+        node_pool& operator=(const node_pool&);
+
+        /** allocate a new chunk, link its nodes into the free list, the first node on top */
+        void grow(){
+            node_type* chunk = static_cast<node_type*>(::operator new(chunk_size_*sizeof(node_type)));
+            chunks_.push_back(chunk);
+            for(std::size_t i = chunk_size_; i > 0; --i){
+                *reinterpret_cast<void**>(chunk + i - 1) = free_;
+                free_ = chunk + i - 1;
+            }
+        }
+
+        std::size_t chunk_size_;
+        void* free_; // head of the free list
+        std::vector<node_type*> chunks_;
+    };
+}
+
+#endif
@@ -34,5 +34,7 @@
 #include "coreneuron_1.0/queue/tool/bin_queue.ipp"
 #include "coreneuron_1.0/queue/tool/sptq_queue.hpp"
 #include "coreneuron_1.0/queue/tool/sptq_queue.ipp"
+#include "coreneuron_1.0/queue/tool/calendar_queue.hpp"
+#include "coreneuron_1.0/queue/tool/calendar_queue.ipp"
 
 #endif
\ No newline at end of file
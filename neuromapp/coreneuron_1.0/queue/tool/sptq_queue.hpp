@@ -36,11 +36,13 @@ THE POSSIBILITY OF SUCH DAMAGE.
 #include <functional>
 
 #include "coreneuron_1.0/queue/tool/algorithm.h"
+#include "coreneuron_1.0/queue/tool/node_pool.hpp"
 
 namespace tool {
 /** The queue: TQeue from Michael starts here, not compliant with std for the container,
 but ok for the type support and the comparator, by default std::less and not std::greated
-as it was in the original version, already a bit of clean up specially for the push ... */
+as it was in the original version, already a bit of clean up specially for the push ...
+The nodes come from the Allocator policy (see node_pool.hpp), a pool by default */
 
 //node for the splay tree
 template<class T>
@@ -80,13 +82,14 @@ sptq_node<T>* sphead(SPTREE<T>*);
 template<class T>
 void spdelete(sptq_node<T>*,SPTREE<T>*);
 
-template<class T = double, class Compare = std::less<T> >
+template<class T = double, class Compare = std::less<T>, class Allocator = node_pool<sptq_node<T> > >
 class sptq_queue {
 public:
     typedef SPTREE<T> container;
     typedef std::size_t size_type;
     typedef T value_type;
     typedef sptq_node<T> node_type;
+    typedef Allocator allocator_type;
 
     inline sptq_queue():size_(0) {
         spinit(&q);
@@ -95,16 +98,23 @@ public:
     inline ~sptq_queue(){
         node_type *n;
         while((n = spdeq(&(&q)->root)) != NULL)
-          delete n;
+          alloc_.destroy(n);
     }
 
     inline void push(value_type value){
-        node_type *n = new node_type(value);
+        node_type *n = alloc_.create(value);
         spenq<T,Compare>(n, &q); // the Comparator is use only here
         size_++;
     }
 
+    /** a node for push(node_type*), from the allocator of the queue */
+    inline node_type* create(value_type value){
+        return alloc_.create(value);
+    }
+
+    /** n from create() or find(), the queue releases it with its allocator */
     inline void push(node_type* n){
+        assert(alloc_.owns(n));
         spenq<T,Compare>(n, &q);
         size_++;
     }
@@ -112,7 +122,7 @@ public:
     inline void pop(){
         if(!empty()){
             node_type *n = spdeq(&(&q)->root);
-            delete n; // pop remove definitively the element else memory leak
+            alloc_.destroy(n); // pop remove definitively the element else memory leak
             size_--;
         }
     }
@@ -148,11 +158,12 @@ public:
 private:
     size_type size_;
     container q;
+    allocator_type alloc_; // gives and recycles the nodes
 };
 
 // carefull the << delete the queue only for debugging 
-template<class T, class Compare>
-std::ostream& operator<< (std::ostream& os, sptq_queue<T,Compare>& q ){
+template<class T, class Compare, class Allocator>
+std::ostream& operator<< (std::ostream& os, sptq_queue<T,Compare,Allocator>& q ){
     q.print(os);
     return os;
 }
@@ -0,0 +1,215 @@
+/*
+ * Neuromapp - trace.h, Copyright (c), 2015,
+ * timothee ewart - Swiss Federal Institute of technology in Lausanne,
+ * timothee.ewart@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details..  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/**
+ * @file neuromapp/coreneuron_1.0/queue/trace.h
+ * Trace of the operations of a queue, recorded by the event_passing
+ * miniapp (queueing::queue) and replayed by the queue miniapp
+ */
+
+#ifndef MAPP_QUEUE_TRACE_
+#define MAPP_QUEUE_TRACE_
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace queue{
+
+    enum trace_op {trace_insert=0, trace_dq};
+
+    /** one operation: insert(t) or atomic_dq(t) repeated repeat_ times in a row
+        (the delivery loop dequeues until the top is later than t) */
+    struct trace_record {
+        explicit trace_record(unsigned char op = trace_insert, double t = 0.):op_(op),repeat_(1),t_(t){}
+        unsigned char op_;
+        unsigned char repeat_;
+        double t_;
+    };
+
+    /** \brief the sequence of operations of one queue, only the times matter for the
+        replay, the data of the events are not kept */
+    class trace {
+    public:
+        typedef std::vector<trace_record>::const_iterator const_iterator;
+
+        inline void insert(double t){
+            records_.push_back(trace_record(trace_insert,t));
+        }
+
+        inline void dq(double til){
+            if(!records_.empty() && records_.back().op_ == trace_dq &&
+               records_.back().t_ == til && records_.back().repeat_ < 255)
+                records_.back().repeat_++;
+            else
+                records_.push_back(trace_record(trace_dq,til));
+        }
+
+        inline std::size_t size() const { return records_.size(); }
+        inline const_iterator begin() const { return records_.begin(); }
+        inline const_iterator end() const { return records_.end(); }
+
+        /** number of insert/atomic_dq calls */
+        inline std::size_t noperations() const {
+            std::size_t n(0);
+            for(const_iterator it = begin(); it != end(); ++it)
+                n += it->repeat_;
+            return n;
+        }
+
+        inline void clear(){ records_.clear(); }
+
+        inline void push_back(const trace_record& r){ records_.push_back(r); }
+
+    private:
+        std::vector<trace_record> records_;
+    };
+
+    /** binary file: "NMQT", version, number of queues (host endianness), then for every
+        queue the size in bytes of its records followed by the records. A record is a flag
+        byte (bit 0: op, bit 1: integral time, bit 2: repeat > 1), the repeat byte if
+        bit 2, then the time: for an integral time the zigzag varint of its difference with
+        the previous time of the queue (1 or 2 bytes in the miniapp), else the raw double */
+    static const char trace_magic[4] = {'N','M','Q','T'};
+    static const unsigned int trace_version = 1;
+
+    /** \fn encode_trace(trace const& tr, std::vector<unsigned char>& buffer)
+     \brief appends the records of tr into buffer with the compact encoding
+     */
+    inline void encode_trace(trace const& tr, std::vector<unsigned char>& buffer){
+        long long prev(0);
+        for(trace::const_iterator it = tr.begin(); it != tr.end(); ++it){
+            const bool in_range = it->t_ > -1e15 && it->t_ < 1e15;
+            const long long k = in_range ? static_cast<long long>(it->t_) : 0;
+            const bool integral = in_range && static_cast<double>(k) == it->t_;
+            buffer.push_back(it->op_ | (integral << 1) | ((it->repeat_ > 1) << 2));
+            if(it->repeat_ > 1)
+                buffer.push_back(it->repeat_);
+            if(integral){
+                const long long d = k - prev;
+                unsigned long long z = (static_cast<unsigned long long>(d) << 1) ^ (d < 0 ? ~0ULL : 0ULL);
+                while(z >= 0x80){
+                    buffer.push_back(static_cast<unsigned char>(z) | 0x80);
+                    z >>= 7;
+                }
+                buffer.push_back(static_cast<unsigned char>(z));
+                prev = k;
+            }else{
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(&it->t_);
+                buffer.insert(buffer.end(), p, p + sizeof(double));
+            }
+        }
+    }
+
+    /** \fn decode_trace(const unsigned char* first, const unsigned char* last, trace& tr)
+     \brief appends to tr the records encoded in [first, last)
+     \return false if the buffer is not a valid encoding
+     */
+    inline bool decode_trace(const unsigned char* first, const unsigned char* last, trace& tr){
+        long long prev(0);
+        while(first != last){
+            const unsigned char flag = *first++;
+            if(flag > 7)
+                return false;
+            trace_record r(flag & 1);
+            if(flag & 4){
+                if(first == last)
+                    return false;
+                r.repeat_ = *first++;
+            }
+            if(flag & 2){
+                unsigned long long z(0);
+                int shift(0);
+                do{
+                    if(first == last || shift > 63)
+                        return false;
+                    z |= static_cast<unsigned long long>(*first & 0x7f) << shift;
+                    shift += 7;
+                }while(*first++ & 0x80);
+                prev += static_cast<long long>(z >> 1) ^ -static_cast<long long>(z & 1);
+                r.t_ = static_cast<double>(prev);
+            }else{
+                if(last - first < static_cast<long>(sizeof(double)))
+                    return false;
+                memcpy(&r.t_, first, sizeof(double));
+                first += sizeof(double);
+            }
+            tr.push_back(r);
+        }
+        return true;
+    }
+
+    /** \fn write_traces(std::string const& name, std::vector<trace> const& traces)
+     \brief write the traces of all the queues of a process into name
+     \return false if the file can not be written
+     */
+    inline bool write_traces(std::string const& name, std::vector<trace> const& traces){
+        FILE* f = fopen(name.c_str(),"wb");
+        if(!f)
+            return false;
+        unsigned int nqueues = traces.size();
+        fwrite(trace_magic,1,4,f);
+        fwrite(&trace_version,sizeof(trace_version),1,f);
+        fwrite(&nqueues,sizeof(nqueues),1,f);
+        std::vector<unsigned char> buffer;
+        for(std::size_t i = 0; i < traces.size(); ++i){
+            buffer.clear();
+            encode_trace(traces[i],buffer);
+            unsigned long long n = buffer.size();
+            fwrite(&n,sizeof(n),1,f);
+            if(n)
+                fwrite(&buffer[0],1,n,f);
+        }
+        bool ok = !ferror(f);
+        fclose(f);
+        return ok;
+    }
+
+    /** \fn read_traces(std::string const& name, std::vector<trace>& traces)
+     \brief read the traces written by write_traces
+     \return false if the file does not exist or is not a trace
+     */
+    inline bool read_traces(std::string const& name, std::vector<trace>& traces){
+        FILE* f = fopen(name.c_str(),"rb");
+        if(!f)
+            return false;
+        char magic[4];
+        unsigned int version(0), nqueues(0);
+        bool ok = fread(magic,1,4,f) == 4 && memcmp(magic,trace_magic,4) == 0
+                  && fread(&version,sizeof(version),1,f) == 1 && version == trace_version
+                  && fread(&nqueues,sizeof(nqueues),1,f) == 1;
+        if(ok)
+            traces.assign(nqueues,trace());
+        std::vector<unsigned char> buffer;
+        for(unsigned int i = 0; ok && i < nqueues; ++i){
+            unsigned long long n(0);
+            ok = fread(&n,sizeof(n),1,f) == 1;
+            if(ok && n){
+                buffer.resize(n);
+                ok = fread(&buffer[0],1,n,f) == n
+                     && decode_trace(&buffer[0], &buffer[0] + n, traces[i]);
+            }
+        }
+        fclose(f);
+        return ok;
+    }
+
+} //end namespace
+
+#endif
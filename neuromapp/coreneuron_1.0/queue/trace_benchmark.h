@@ -0,0 +1,109 @@
+//
+//  trace_benchmark.h
+//  queue
+//
+//  replay of the traces recorded by the event_passing miniapp
+//
+
+#ifndef trace_benchmark_h
+#define trace_benchmark_h
+
+#include <string>
+#include <sstream>
+#include <vector>
+
+#include "coreneuron_1.0/queue/trace.h"
+#include "coreneuron_1.0/queue/timer_asm.h"
+
+namespace queue{
+
+    /** \brief log2 histogram of cycles: bucket b counts the operations of [2^b, 2^(b+1)) cycles */
+    class cycle_histogram {
+    public:
+        enum {nbuckets = 32};
+
+        cycle_histogram():count_(0),sum_(0),buckets_(nbuckets,0){}
+
+        inline void add(unsigned long long cycles){
+            int b(0);
+            while((cycles >> (b+1)) && b < nbuckets-1)
+                ++b;
+            buckets_[b]++;
+            count_++;
+            sum_ += cycles;
+        }
+
+        inline unsigned long long count() const { return count_; }
+
+        inline double mean() const { return count_ ? sum_/static_cast<double>(count_) : 0.; }
+
+        /** upper bound (2^(b+1)) of the bucket of the q quantile, 0 < q <= 1 */
+        inline unsigned long long quantile(double q) const {
+            unsigned long long n(0);
+            for(int b = 0; b < nbuckets; ++b){
+                n += buckets_[b];
+                if(n > 0 && n >= q*count_)
+                    return 2ULL << b;
+            }
+            return 0;
+        }
+
+        /** count,mean,p50,p99,bucket_0,...,bucket_31 */
+        std::string csv() const {
+            std::stringstream s;
+            s << count_ << "," << mean() << "," << quantile(0.5) << "," << quantile(0.99);
+            for(int b = 0; b < nbuckets; ++b)
+                s << "," << buckets_[b];
+            return s.str();
+        }
+
+    private:
+        unsigned long long count_;
+        unsigned long long sum_;
+        std::vector<unsigned long long> buckets_;
+    };
+
+    /** \brief replays the traces of all the queues of a process: one fresh queue per
+        trace, as every cell group owns its queue. A dq is the atomic_dq of
+        queueing::queue: pop the top if it is not later than the time */
+    struct trace_helper {
+
+        template<class T>
+        static void replay(std::vector<trace> const& traces,
+                           cycle_histogram& insert, cycle_histogram& dq){
+            typedef typename T::value_type value_type;
+            unsigned long long t1(0),t2(0);
+            for(std::size_t i = 0; i < traces.size(); ++i){
+                value_type queue;
+                for(trace::const_iterator it = traces[i].begin(); it != traces[i].end(); ++it){
+                    if(it->op_ == trace_insert){
+                        t1 = rdtsc();
+                        queue.push(it->t_);
+                        t2 = rdtsc();
+                        insert.add(t2-t1);
+                    }else{
+                        for(int k = 0; k < it->repeat_; ++k){
+                            t1 = rdtsc();
+                            if(!queue.empty() && queue.top() <= it->t_)
+                                queue.pop();
+                            t2 = rdtsc();
+                            dq.add(t2-t1);
+                        }
+                    }
+                }
+            }
+        }
+
+        /** one line per operation: queue,op,count,mean,p50,p99,histogram */
+        template<class T>
+        static std::string benchmark(std::vector<trace> const& traces){
+            cycle_histogram insert, dq;
+            replay<T>(traces,insert,dq);
+            return std::string(T::name) + ",insert," + insert.csv() + "\n"
+                 + std::string(T::name) + ",atomic_dq," + dq.csv() + "\n";
+        }
+    };
+
+} //end namespace
+
+#endif
@@ -19,7 +19,8 @@
 #include "coreneuron_1.0/queue/tool/priority_queue.hpp" // MH work
 
 enum container {sptq_queue, bin_queue, priority_queue,binomial_heap,
-                fibonacci_heap,pairing_heap,skew_heap,d_ary_heap};
+                fibonacci_heap,pairing_heap,skew_heap,d_ary_heap,calendar_queue,
+                sptq_queue_pool,bin_queue_pool};
 //serial queue
 template<container q>
 struct helper_type;
@@ -32,16 +33,35 @@ struct helper_type<priority_queue>{
 
 template<>
 struct helper_type<sptq_queue>{
-    typedef tool::sptq_queue<double, std::greater<double> > value_type;
+    typedef tool::sptq_queue<double, std::greater<double>,
+                             tool::new_allocator<tool::sptq_node<double> > > value_type;
     const static char name[];
 };
 
 template<>
 struct helper_type<bin_queue>{ // no comparator great by default
+    typedef tool::bin_queue<double, tool::new_allocator<tool::bin_node<double> > > value_type;
+    const static char name[];
+};
+
+template<>
+struct helper_type<sptq_queue_pool>{ // nodes from the default node_pool
+    typedef tool::sptq_queue<double, std::greater<double> > value_type;
+    const static char name[];
+};
+
+template<>
+struct helper_type<bin_queue_pool>{
     typedef tool::bin_queue<double> value_type;
     const static char name[];
 };
 
+template<>
+struct helper_type<calendar_queue>{ // no comparator, smallest first as bin_queue
+    typedef tool::calendar_queue<double> value_type;
+    const static char name[];
+};
+
 template<>
 struct helper_type<binomial_heap>{
     typedef boost::heap::binomial_heap<double, boost::heap::compare<std::greater<double> > > value_type;
@@ -76,6 +96,9 @@ struct helper_type<d_ary_heap>{
 const char helper_type<priority_queue>::name[] = "std::priority_queue";
 const char helper_type<sptq_queue>::name[] = "original_sptq_queue";
 const char helper_type<bin_queue>::name[] = "original_bin_queue";
+const char helper_type<sptq_queue_pool>::name[] = "sptq_queue_pool";
+const char helper_type<bin_queue_pool>::name[] = "bin_queue_pool";
+const char helper_type<calendar_queue>::name[] = "calendar_queue";
 const char helper_type<binomial_heap>::name[] = "boost::binomial_heap";
 const char helper_type<fibonacci_heap>::name[] = "boost::fibonacci_heap";
 const char helper_type<pairing_heap>::name[] = "boost::pairing_heap";
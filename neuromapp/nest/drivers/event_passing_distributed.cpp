@@ -39,7 +39,7 @@
 
 
 int main(int argc, char* argv[]) {
-    assert(argc == 16);
+    assert(argc >= 16 && argc <= 22);
 
     MPI_Init(NULL, NULL);
     int rank, size;
@@ -62,6 +62,18 @@ int main(int argc, char* argv[]) {
     double syn_tau_rec = boost::lexical_cast<double>(argv[13]);
     double syn_tau_fac = boost::lexical_cast<double>(argv[14]);
     bool pool = boost::lexical_cast<bool>(argv[15]);
+    //build the connections from inverted target lists (optional)
+    bool inverted = argc >= 17 && boost::lexical_cast<bool>(argv[16]);
+    //send the spikes only to the ranks of their targets (optional)
+    bool alltoall = argc >= 18 && boost::lexical_cast<bool>(argv[17]);
+    //predictive size of the allgather buffers, optionally shrinking (optional)
+    bool predictive = argc >= 19 && boost::lexical_cast<bool>(argv[18]);
+    bool shrink = argc >= 20 && boost::lexical_cast<bool>(argv[19]);
+    //deliver the spikes sorted by source (optional)
+    bool sorted = argc >= 21 && boost::lexical_cast<bool>(argv[20]);
+    //freeze the connections once built (optional): the destroyed connectors
+    //are only given back with the pool (malloc mode), the peak memory grows
+    bool freeze = argc >= 22 && boost::lexical_cast<bool>(argv[21]);
 
     //use program options to pass parameters
     namespace po = boost::program_options;
@@ -120,23 +132,73 @@ int main(int argc, char* argv[]) {
         environment::event_generator::iterator it_gen_vp = generator.begin();
         std::advance(it_gen_vp, thrd);
         generate_poisson_events_neuron(it_gen_vp, 1234, simtime, firing_rate/static_cast<double>(neuron_vp_dist.getglobalcells()), neuron_vp_dist);
-        //build up network
-        nest::build_connections_from_neuron(thrd, neuron_vp_dist, presyns, detectors_targetindex, cn);
+    }
+
+    //build up network
+    double build_time = omp_get_wtime();
+    if (inverted) {
+        nest::build_connections_inverted(neuro_dist, presyns, detectors_targetindex, cn);
+    }
+    else {
+        #pragma omp parallel
+        {
+            const int thrd = omp_get_thread_num();
+            environment::continousdistribution neuron_vp_dist(omp_get_num_threads(), thrd, &neuro_dist);
+            nest::build_connections_from_neuron(thrd, neuron_vp_dist, presyns, detectors_targetindex, cn);
+        }
+    }
+    build_time = omp_get_wtime() - build_time;
+
+    long l_nconnections = 0;
+    #pragma omp parallel reduction(+:l_nconnections)
+    {
+        const int thrd = omp_get_thread_num();
+        l_nconnections += cn.num_connections(thrd);
+        //no connection is added from here on
+        if (freeze)
+            cn.freeze(thrd);
+    }
+    long g_nconnections;
+    MPI_Reduce( &l_nconnections, &g_nconnections, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD );
+    double max_build_time;
+    MPI_Reduce( &build_time, &max_build_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD );
+    if(rank == 0){
+        std::cout<<"connection build ("<<(inverted ? "inverted" : "scan")<<(freeze ? ", frozen" : "")<<", "<<nthreads<<" threads): "
+                 <<1000. * max_build_time<<" ms, "<<g_nconnections<<" synapses";
+        if (max_build_time > 0.)
+            std::cout<<", "<<g_nconnections / max_build_time<<" synapses/s";
+        std::cout<<std::endl;
     }
 
     nest::eventdelivermanager edm(cn, size, nthreads, mindelay);
+    nest::target_table targets;
+    if (alltoall) {
+        targets.build(neuro_dist, presyns);
+        edm.use_target_table(targets);
+    }
+    if (predictive)
+        edm.use_buffer_sizing(nest::buffer_sizing(0.9, 1.5, shrink));
+    if (sorted)
+        edm.use_sorted_delivery();
     nest::simulationmanager sm(edm, generator, rank, size, nthreads);
 
+    long l_events = 0;
+    for (int thrd=0; thrd<nthreads; thrd++)
+        l_events += generator.get_size(thrd);
+
     struct timeval start, end;
     //run simulation
     gettimeofday(&start, NULL);
 
     int t = 0;
+    double gather_time = 0.;
+    double gather_start = 0.;
+    double deliver_time = 0.;
     long from_step = 0;
     long to_step = mindelay;
     long Tstop = simtime;
 
-    #pragma omp parallel
+    #pragma omp parallel reduction(+:deliver_time)
     {
         const int thrd = omp_get_thread_num();
 
@@ -144,13 +206,21 @@ int main(int argc, char* argv[]) {
             #pragma omp barrier
 
             // deliver only from second time step on
-            if (t>0)
+            if (t>0) {
+                const double deliver_start = omp_get_wtime();
                 edm.deliver_events(thrd, t);
+                deliver_time += omp_get_wtime() - deliver_start;
+            }
             sm.update(thrd, t, from_step, to_step);
             #pragma omp barrier
             #pragma omp master
+            gather_start = omp_get_wtime();
+            //the threads copy their spikes in parallel
+            edm.collocate_events(thrd);
+            #pragma omp master
             {
                 edm.gather_events();
+                gather_time += omp_get_wtime() - gather_start;
             }
             
             #pragma omp master
@@ -166,6 +236,14 @@ int main(int argc, char* argv[]) {
 
     gettimeofday(&end, NULL);
 
+    //every thread delivers all the spikes sent (but the last interval)
+    for (int thrd=0; thrd<nthreads; thrd++)
+        l_events -= generator.get_size(thrd);
+    long g_events;
+    MPI_Reduce( &l_events, &g_events, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD );
+    double max_deliver_time;
+    MPI_Reduce( &deliver_time, &max_deliver_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD );
+
     long long diff_ms = (1000 * (end.tv_sec - start.tv_sec))
         + ((end.tv_usec - start.tv_usec) / 1000);
 
@@ -189,7 +267,23 @@ int main(int argc, char* argv[]) {
     double g_sumtime;
     MPI_Reduce( &l_sumtime, &g_sumtime, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD );
 
+    //communication volume, per rank and exchange
+    const nest::comm_volume& volume = edm.get_comm_volume();
+    unsigned long l_volume[2] = {volume.sent, volume.received};
+    unsigned long g_volume[2];
+    MPI_Reduce( l_volume, g_volume, 2, MPI_UNSIGNED_LONG, MPI_SUM, 0, MPI_COMM_WORLD );
+
     if(rank == 0){
+        const double per_exchange = volume.exchanges > 0 ? static_cast<double>(sizeof(uint_t)) / (size * volume.exchanges) : 0.;
+        std::cout<<"communication ("<<(alltoall ? "alltoall" : "allgather")<<", "<<size<<" processes): "
+                 <<g_volume[0] * per_exchange<<" bytes sent, "<<g_volume[1] * per_exchange
+                 <<" bytes received per rank and exchange, "<<volume.exchanges<<" exchanges, "
+                 <<volume.overflows<<" overflows"<<std::endl;
+        std::cout<<"gather events ("<<nthreads<<" threads): "<<1e6 * gather_time / (volume.exchanges > 0 ? volume.exchanges : 1)<<" us per exchange"<<std::endl;
+        std::cout<<"deliver events ("<<(sorted ? "sorted" : "buffer order")<<", "<<nthreads<<" threads): ";
+        if (max_deliver_time > 0.)
+            std::cout<<g_events * nthreads / max_deliver_time<<" spikes/s per thread";
+        std::cout<<std::endl;
         std::cout<<"run time: "<<diff_ms<<" ms"<<std::endl;
         std::cout<<"statistics: num_recv="<< g_num << " acc_spike_times=" << g_sumtime << std::endl;
     }
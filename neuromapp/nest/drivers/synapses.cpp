@@ -112,10 +112,17 @@ namespace nest
         if (use_manager || use_mpi || use_connector)
             desc.add_options()
             ("pool", po::value<bool>()->default_value(false), "pool memory manager") //memory pool for hte connector
-            ("fanout", po::value<int>()->default_value(1), "number of incoming(manager)/outgoing(connector) connections");
+            ("fanout", po::value<int>()->default_value(1), "number of incoming(manager)/outgoing(connector) connections")
+            ("soa", "structure of arrays connectors: one array per synapse parameter, x and u of all the targets updated in one loop");
+
+        if (use_manager || use_connector)
+            desc.add_options()
+            ("slab", "thread local slab allocator with size classes, reuses the memory of the replaced connectors")
+            ("direct", "devirtualized send: spike counters as direct targets, no virtual call per synapse");
 
         if (use_manager || use_mpi)
             desc.add_options()
+            ("freeze", "compact the connectors into one arena indexed by source gid once connected")
             ("min_delay", po::value<int>()->default_value(2), "min delay of simulation")
             ("nThreads", po::value<int>()->default_value(1), "number of threads")
             ("nProcesses", po::value<int>()->default_value(1), "number of ranks")
@@ -125,7 +132,12 @@ namespace nest
         if (use_mpi)
             desc.add_options()
             ("run", po::value<std::string>()->default_value("/usr/bin/mpiexec"), "mpi run command")
-            ("rate", po::value<double>()->default_value(-1), "firing rate per neuron");
+            ("rate", po::value<double>()->default_value(-1), "firing rate per neuron")
+            ("inverted", "build the connections from target lists inverted once per rank instead of every thread scanning all the cells")
+            ("alltoall", "send the spikes only to the ranks hosting their targets (target tables, MPI_Alltoallv) instead of MPI_Allgather")
+            ("predictive", "size the MPI_Allgather buffers from a decaying maximum of the past exchanges instead of after every overflow")
+            ("shrink", "with predictive, also shrink the MPI_Allgather buffers")
+            ("sorted", "deliver the spikes sorted by source gid (radix sort, prefetch of the next connections)");
 
         if (use_manager)
             desc.add_options()
@@ -245,6 +257,21 @@ namespace nest
         }
     }
 
+    /** \fn print_slab_stats(const slab_stats& st)
+        \brief prints what the slab allocator of a thread holds
+        \param st statistics of the allocator
+     */
+    void print_slab_stats(const slab_stats& st)
+    {
+        std::cout << "Slab allocator:" << std::endl;
+        std::cout << "\tallocations: " << st.nallocs << " (" << st.nreused << " reused), frees: "
+                  << st.nfrees << ", slabs reused: " << st.nslabs_reused << std::endl;
+        std::cout << "\tlive: " << st.live_bytes << " bytes, slabs: " << st.slab_bytes
+                  << " bytes, fragmentation: " << 100. * st.fragmentation() << "%" << std::endl;
+        std::cout << "\tpeak live: " << st.peak_live_bytes << " bytes, peak slabs: "
+                  << st.peak_slab_bytes << " bytes" << std::endl;
+    }
+
     /** \fn content(po::variables_map const& vm)
         \brief Execute the NEST synapse Miniapp.
         \param vm encapsulate the command line and all needed informations
@@ -299,7 +326,9 @@ namespace nest
                 syn_model << " " << syn_delay << " " <<
                 syn_weight << " " << syn_U << " " <<
                 syn_u << " " << syn_x << " " <<
-                syn_tau_rec << " " << syn_tau_fac << " " << pool;
+                syn_tau_rec << " " << syn_tau_fac << " " << pool << " " << vm.count("inverted") << " " << vm.count("alltoall") <<
+                " " << vm.count("predictive") << " " << vm.count("shrink") <<
+                " " << vm.count("sorted") << " " << vm.count("freeze");
 
             std::cout<< "Running command " << command.str() <<std::endl;
             system(command.str().c_str());
@@ -322,7 +351,7 @@ namespace nest
             const int fanout = vm["fanout"].as<int>();
 
             //setup allocator
-            nest::pool_env penv(nthreads, pool);
+            nest::pool_env penv(nthreads, pool, vm.count("slab"));
 
             //build connection manager
             connectionmanager cm(vm);
@@ -331,7 +360,7 @@ namespace nest
             presyns(thrd, &neuro_dist);
 
             //preallocate vector for results
-            std::vector<spikedetector> detectors(ncells);
+            std::vector<spikecounter> detectors(ncells);
             std::vector<targetindex> detectors_targetindex(ncells);
 
             // register spike detectors
@@ -344,6 +373,13 @@ namespace nest
             environment::continousdistribution neuro_vp_dist(nthreads, thrd, &neuro_dist);
             build_connections_from_neuron(thrd, neuro_vp_dist, presyns, detectors_targetindex, cm);
 
+            const size_t nconnections = cm.num_connections(thrd);
+            const size_t memory_connectors = cm.memory(thrd);
+            if (vm.count("slab"))
+                print_slab_stats(poormansallocpool[omp_get_thread_num()].stats());
+            if (vm.count("freeze"))
+                cm.freeze(thrd);
+
             // generate all events for one thread
             environment::event_generator generator(1);
             double mean = static_cast<double>(simtime) / static_cast<double>(nSpikes);
@@ -356,6 +392,8 @@ namespace nest
                              simtime, nthreads, rank, size, lambda, &event_dist);
 
             const unsigned int stats_generated_spikes = generator.get_size(0);
+            const bool direct = vm.count("direct");
+            const direct_target<spikecounter> targets(detectors, detectors_targetindex);
             int t = 0;
             spikeevent se;
             boost::chrono::system_clock::time_point start = boost::chrono::system_clock::now();
@@ -367,7 +405,10 @@ namespace nest
                     index nid = g.first;
                     se.set_stamp( Time(g.second) ); // in Network::send< SpikeEvent >
                     se.set_sender_gid( nid ); // in Network::send< SpikeEvent >
-                    cm.send(thrd, nid, se); //send spike
+                    if (direct)
+                        cm.send(thrd, nid, se, targets); //send spike, no virtual call per synapse
+                    else
+                        cm.send(thrd, nid, se); //send spike
                 }
             }
             delay = boost::chrono::system_clock::now() - start;
@@ -376,8 +417,22 @@ namespace nest
             std::cout << "\tgenerated spikes: " << stats_generated_spikes << std::endl;
             int recvSpikes=0;
             for (unsigned int i=0; i<detectors.size(); i++)
-                recvSpikes+=detectors[i].spikes.size();
+                recvSpikes+=detectors[i].num;
             std::cout << "\trecv spikes: " << recvSpikes << std::endl;
+            if (nconnections > 0) {
+                std::cout << "\tconnections: " << nconnections << std::endl;
+                std::cout << "\tmemory per synapse (connectors): "
+                          << static_cast<double>(memory_connectors) / nconnections << " bytes" << std::endl;
+                if (vm.count("freeze"))
+                    std::cout << "\tmemory per synapse (frozen): "
+                              << static_cast<double>(cm.memory(thrd)) / nconnections << " bytes" << std::endl;
+            }
+            const double seconds = boost::chrono::duration<double>(delay).count();
+            if (seconds > 0.)
+                std::cout << "\tthroughput: " << recvSpikes / seconds << " synapse events/s"
+                          << (vm.count("freeze") ? " (frozen)" : "") << (direct ? " (direct)" : "") << std::endl;
+            if (recvSpikes > 0)
+                std::cout << "\tper synapse: " << 1e9 * seconds / recvSpikes << " ns" << std::endl;
 
             std::cout << "\tEvents left:" << std::endl;
 
@@ -399,10 +454,10 @@ namespace nest
             const int fanout = vm["fanout"].as<int>();
 
             //setup allocator
-            nest::pool_env penv(1, pool); // use one thread
+            nest::pool_env penv(1, pool, vm.count("slab")); // use one thread
 
             //preallocate vector for results
-            std::vector<spikedetector> detectors(fanout);
+            std::vector<spikecounter> detectors(fanout);
             std::vector<targetindex> detectors_targetindex(fanout);
             for(unsigned int i=0; i < fanout; ++i) {
                 detectors[i].set_lid(i);    //give nodes a local id
@@ -418,7 +473,10 @@ namespace nest
             for(unsigned int i=0; i < fanout; ++i) {
                 //TODO permute parameters
                 tsodyks2 synapse(syn_delay, syn_weight, syn_U, syn_u, syn_x, syn_tau_rec, syn_tau_fac, detectors_targetindex[i%fanout]);
-                conn = add_connection(conn, synapse); //use static function from connectionmanager
+                if (vm.count("soa"))
+                    conn = add_soa_connection(conn, synapse);
+                else
+                    conn = add_connection(conn, synapse); //use static function from connectionmanager
             }
 
             //create a few events
@@ -429,13 +487,30 @@ namespace nest
                 events[i].set_sender( NULL ); // in Network::send< SpikeEvent >
             }
 
+            const direct_target<spikecounter> targets(detectors, detectors_targetindex);
             boost::chrono::system_clock::time_point start = boost::chrono::system_clock::now();
-            for (unsigned int i=0; i<nSpikes; i++) {
-                conn->send(events[i]); //send spike
+            if (vm.count("direct")) {
+                for (unsigned int i=0; i<nSpikes; i++)
+                    conn->send(events[i], targets); //send spike, no virtual call per synapse
+            }
+            else {
+                for (unsigned int i=0; i<nSpikes; i++)
+                    conn->send(events[i]); //send spike
             }
 
             delay = boost::chrono::system_clock::now() - start;
-            std::cout << "Connector simulated with " << fanout << " connections" << std::endl;
+            if (vm.count("slab"))
+                print_slab_stats(poormansallocpool[0].stats());
+            std::cout << "Connector simulated with " << fanout << " connections"
+                      << (vm.count("soa") ? " (structure of arrays)" : "")
+                      << (vm.count("direct") ? " (direct)" : "") << std::endl;
+            const double seconds = boost::chrono::duration<double>(delay).count();
+            if (seconds > 0.)
+                std::cout << "Throughput: " << static_cast<double>(nSpikes) * fanout / seconds
+                          << " spikes x synapses/s" << std::endl;
+            if (nSpikes > 0 && fanout > 0)
+                std::cout << "Per synapse: " << 1e9 * seconds / (static_cast<double>(nSpikes) * fanout)
+                          << " ns" << std::endl;
         }
         else {
             const double syn_delay = vm["delay"].as<double>();
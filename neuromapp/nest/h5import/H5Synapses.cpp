@@ -57,40 +57,26 @@ void H5Synapses::threadConnectNeurons( SynapseList& synapses )
  *  Aftewards all synapses are on their target nodes
  */
 CommunicateSynapses_Status
-H5Synapses::CommunicateSynapses( SynapseList& synapses )
+H5Synapses::CommunicateSynapses( SynapseBlock& block )
 {
 #ifdef SCOREP_COMPILE
   SCOREP_USER_REGION( "alltoall", SCOREP_USER_REGION_TYPE_FUNCTION )
 #endif
   uint32_t num_processes = kernel().mpi_manager.get_num_processes();
+  SynapseList& synapses = block.synapses;
 
-  int sendcounts[ num_processes ], recvcounts[ num_processes ],
+  // send buffer and counts filled by sort
+  int* sendcounts = &block.sendcounts[ 0 ];
+  int recvcounts[ num_processes ],
     rdispls[ num_processes + 1 ], sdispls[ num_processes + 1 ];
   for ( int32_t i = 0; i < num_processes; i++ )
   {
-    sendcounts[ i ] = 0;
     sdispls[ i ] = 0;
     recvcounts[ i ] = -999;
     rdispls[ i ] = -999;
   }
 
   const int intsizeof_entry = synapses.sizeof_entry()/sizeof(int);
-  mpi_buffer<int> send_buffer(synapses.size() * intsizeof_entry, true);
-
-  // store number of int values per entry
-  int entriesadded;
-
-  #pragma omp parallel for
-  for ( size_t i = 0; i < synapses.size(); i++ )
-  {
-    const size_t offset = i * intsizeof_entry;
-    // serialize entry
-    entriesadded = synapses[ i ].serialize( send_buffer, offset );
-
-    // save number of values added
-    #pragma omp atomic
-    sendcounts[ synapses[ i ].node_id_ ] += entriesadded;
-  }
 
   MPI_Alltoall(
     sendcounts, 1, MPI_INT, recvcounts, 1, MPI_INT, MPI_COMM_WORLD );
@@ -109,7 +95,7 @@ H5Synapses::CommunicateSynapses( SynapseList& synapses )
   // allocate recv buffer
   mpi_buffer<int> recvbuf( rdispls[ num_processes ], true );
 
-  MPI_Alltoallv( send_buffer.begin(),
+  MPI_Alltoallv( block.send_buffer.begin(),
     sendcounts,
     sdispls,
     MPI_INT,
@@ -153,52 +139,20 @@ void H5Synapses::integrateMapping( SynapseList& synapses )
   }
 }
 
-//helper for sort
-typedef std::pair< int, int > intpair;
-inline bool first_less( const intpair& l, const intpair& r ) { return l.first < r.first; };
-
+/**
+ *  Serialize the synapses into the send buffer, sorted by destination rank
+ *  (counting sort on node_id_), and free the synapse list
+ */
 void
-H5Synapses::sort( SynapseList& synapses )
+H5Synapses::sort( SynapseBlock& block )
 {
 #ifdef SCOREP_COMPILE
     SCOREP_USER_REGION( "sort", SCOREP_USER_REGION_TYPE_FUNCTION )
 #endif
-    if ( synapses.size() > 1 )
-    {
-        // arg sort
-        std::vector< intpair > v_idx( synapses.size() );
-        for ( int i = 0; i < v_idx.size(); i++ )
-        {
-            v_idx[ i ].first = synapses[ i ].node_id_;
-            v_idx[ i ].second = i;
-        }
-        std::sort( v_idx.begin(), v_idx.end(), first_less);
-
-        // create buf object
-        uint32_t source_neuron_tmp;
-        uint32_t node_id_tmp;
-        std::vector< char > pool_tmp( synapses.sizeof_entry() );
-        SynapseRef buf( source_neuron_tmp,
-                node_id_tmp,
-                synapses.get_num_params(),
-                &pool_tmp[0] );
-
-        //apply reordering based on v_idx[:].second
-        size_t i, j, k;
-        for(i = 0; i < synapses.size(); i++){
-            if(i != v_idx[ i ].second){
-                buf = synapses[i];
-                k = i;
-                while(i != (j = v_idx[ k ].second)){
-                    synapses[k] = synapses[j];
-                    v_idx[ k ].second = k;
-                    k = j;
-                }
-                synapses[k] = buf;
-                v_idx[ k ].second = k;
-            }
-        }
-    }
+    block.synapses.serialize_sorted( block.send_buffer,
+                                     block.sendcounts,
+                                     kernel().mpi_manager.get_num_processes() );
+    block.synapses.release();
 }
 
 void H5Synapses::import()
@@ -217,7 +171,7 @@ void H5Synapses::import()
   uint64_t t_load=0;
   uint64_t t_mpicon=0;
   uint64_t t_push=0;
-  std::queue< SynapseList* > synapse_queue;
+  std::queue< SynapseBlock* > synapse_queue;
 
   // add all synapses into queue
   gettimeofday(&start_push, NULL);
@@ -229,7 +183,7 @@ void H5Synapses::import()
                 #ifdef SCOREP_COMPILE
                 SCOREP_USER_REGION( "enqueue", SCOREP_USER_REGION_TYPE_FUNCTION )
                 #endif
-                SynapseList* newone = new SynapseList( model_params_.size() );
+                SynapseBlock* newone = new SynapseBlock( model_params_.size() );
 
                 h5reader::h5view dataspace_view;
                 {
@@ -238,7 +192,7 @@ void H5Synapses::import()
                     #endif
 
                     gettimeofday(&start_load, NULL);
-                    synloader.readblock( *newone, dataspace_view );
+                    synloader.readblock( newone->synapses, dataspace_view );
                     gettimeofday(&end_load, NULL);
                 }
                 t_load += (1000 * (end_load.tv_sec - start_load.tv_sec))
@@ -247,7 +201,7 @@ void H5Synapses::import()
                 #pragma omp task firstprivate(newone, dataspace_view)
                 {
                     //synloader.integrateSourceNeurons( *newone, dataspace_view );
-                    integrateMapping(*newone);
+                    integrateMapping(newone->synapses);
                     sort(*newone);
                 }
                 synapse_queue.push(newone);
@@ -263,13 +217,13 @@ void H5Synapses::import()
        SCOREP_USER_REGION( "dequeue", SCOREP_USER_REGION_TYPE_FUNCTION )
         #endif
         gettimeofday(&start_mpicon, NULL);
-        SynapseList* synapses = synapse_queue.front();
+        SynapseBlock* block = synapse_queue.front();
         synapse_queue.pop();
 
-        com_status = CommunicateSynapses( *synapses );
-        threadConnectNeurons( *synapses );
+        com_status = CommunicateSynapses( *block );
+        threadConnectNeurons( block->synapses );
 
-        delete synapses;
+        delete block;
 
         gettimeofday(&end_mpicon, NULL);
         t_mpicon += (1000 * (end_mpicon.tv_sec - start_mpicon.tv_sec))
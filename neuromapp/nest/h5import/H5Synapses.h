@@ -23,6 +23,21 @@ enum CommunicateSynapses_Status
   UNSET
 };
 
+/**
+ * block of synapses read from the file and its send buffer, sorted by
+ * destination rank
+ */
+struct SynapseBlock
+{
+  SynapseList synapses;
+  mpi_buffer< int > send_buffer;
+  std::vector< int > sendcounts;
+
+  SynapseBlock( const size_t& num_params )
+    : synapses( num_params ), send_buffer( 0 )
+  {}
+};
+
 /**
  * H5Synapses - load Synapses from HDF5 and distribute to nodes
  *
@@ -46,9 +61,9 @@ private:
     }
 
   CommunicateSynapses_Status
-       CommunicateSynapses( SynapseList& synapses );
+       CommunicateSynapses( SynapseBlock& block );
   void threadConnectNeurons( SynapseList& synapses );
-  void sort( SynapseList& synapses );
+  void sort( SynapseBlock& block );
   void integrateMapping( SynapseList& synapses );
   void addKernel( std::string name, TokenArray params );
 
@@ -1,5 +1,9 @@
 #include <iostream>
 #include <vector>
+#include <cassert>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 #ifndef NESTNODESYNAPSE_CLASS
@@ -45,6 +49,12 @@ public:
         else
             buf.reserve(n);
     }
+    void resize(const size_t& new_n)
+    {
+        buf.resize(new_n);
+        n = new_n;
+        readalready = 0;
+    }
     T* begin()
     {
         return &buf[readalready];
@@ -216,11 +226,81 @@ public:
     node_id_.clear();
     property_pool_.clear();
   }
+  /**
+   * Frees the memory of the entries
+   */
+  inline void release()
+  {
+    std::vector< uint32_t >().swap( source_neurons );
+    std::vector< uint32_t >().swap( node_id_ );
+    std::vector< char >().swap( property_pool_ );
+  }
   inline size_t size() const
   {
     return source_neurons.size();
   }
 
+  /**
+   * Serialize all entries into buf, sorted by node_id_: stable counting
+   * sort over the OpenMP threads, which scatter the entries directly to
+   * their position. buf is the send buffer of MPI_Alltoallv and
+   * sendcounts[ r ] the number of int values for rank r.
+   */
+  void serialize_sorted( mpi_buffer< int >& buf,
+                         std::vector< int >& sendcounts,
+                         const size_t& num_processes )
+  {
+    const size_t n = size();
+    const size_t intsizeof_entry = sizeof_entry() / sizeof( int );
+    // counts, then positions, of every thread and rank, padded by a cache line
+    const size_t stride = num_processes + 8;
+    std::vector< size_t > offsets;
+    buf.resize( n * intsizeof_entry );
+    sendcounts.assign( num_processes, 0 );
+
+    #pragma omp parallel default( shared )
+    {
+#ifdef _OPENMP
+      const size_t thrd = omp_get_thread_num();
+      const size_t nthreads = omp_get_num_threads();
+#else
+      const size_t thrd = 0;
+      const size_t nthreads = 1;
+#endif
+      #pragma omp single
+      offsets.assign( nthreads * stride, 0 );
+      size_t* counts = &offsets[ thrd * stride ];
+
+      // the static schedule gives every thread the same chunk in both loops
+      #pragma omp for schedule( static )
+      for ( size_t i = 0; i < n; i++ )
+      {
+        assert( node_id_[ i ] < num_processes );
+        counts[ node_id_[ i ] ]++;
+      }
+
+      #pragma omp single
+      {
+        size_t pos = 0;
+        for ( size_t r = 0; r < num_processes; r++ )
+        {
+          const size_t first = pos;
+          for ( size_t t = 0; t < nthreads; t++ )
+          {
+            const size_t c = offsets[ t * stride + r ];
+            offsets[ t * stride + r ] = pos;
+            pos += c;
+          }
+          sendcounts[ r ] = ( pos - first ) * intsizeof_entry;
+        }
+      }
+
+      #pragma omp for schedule( static )
+      for ( size_t i = 0; i < n; i++ )
+        ( *this )[ i ].serialize( buf, intsizeof_entry * counts[ node_id_[ i ] ]++ );
+    }
+  }
+
   inline size_t sizeof_pool_entry()
   {
       return num_params_ * sizeof( float ) + sizeof( uint32_t );
@@ -116,21 +116,32 @@ struct connection{
                  */
         inline void send(event& e, double t_lastspike)
         {
-            double h = e.get_stamp().get_ms() - t_lastspike;
-            double x_decay = std::exp(-h / tau_rec_); /// To be checked which implementation of exponential is being used
-            double u_decay = (tau_fac_ < 1.0e-10) ? 0.0 : std::exp(-h / tau_fac_); // branching
-            // now we compute spike number n+1
-            /// no forward dependency between next 2 statements
-            x_ = 1. + (x_ - x_ * u_ - 1.) * x_decay; // Eq. 5 from reference [3] ---> 2 Multiply + 3 adds + 1 assignment
-            u_ = U_ + u_ * (1. - U_) * u_decay; // Eq. 4 from [3] --> 2 Muliply + 2 adds + 1 assignment
+            const double weight = update_(e.get_stamp().get_ms() - t_lastspike);
             node* target_node = scheduler::get_target(target_); //reduced call tree in comparison to NEST. Further, thread number is passed to get_target
             assert(target_node != NULL);
             e.set_receiver( target_node ); //simplification
-            e.set_weight(x_ * u_ * weight_); // weight constant for the object after the synapase is created (can we use const?) --> 2 Multiply +  1 assignment
+            e.set_weight(weight); // weight constant for the object after the synapase is created (can we use const?) --> 2 Multiply +  1 assignment
             //e.set_delay( delay_ ); //  1 assignment
             //e.set_rport( -1 );
             e(); // append right now, in nest sending to post synaptic neuron
         }
+
+        /** \fn void send(spikeevent& e, double t_lastspike, const direct_target<NodeT>& targets)
+                \brief same as send(), the target is a NodeT found by its direct handle:
+                    no virtual call, the update and the handler of the target inline
+                    \param e spike event
+                    \param t_lastspike time of last spike
+                    \param targets nodes of the targets
+                 */
+        template < typename NodeT >
+        inline void send(spikeevent& e, double t_lastspike, const direct_target< NodeT >& targets)
+        {
+            const double weight = update_(e.get_stamp().get_ms() - t_lastspike);
+            NodeT& target_node = targets[ target_ ];
+            e.set_receiver( &target_node );
+            e.set_weight(weight);
+            target_node.NodeT::handle( e );
+        }
         /** \fun delay() const
             \brief get delay, read only */
         inline const long& delay() const
@@ -230,6 +241,21 @@ struct connection{
         }
 
     private:
+        /** \fn double update_(double h)
+                \brief updates x and u for a spike h ms after the last one
+                    \return the weight of the spike
+                 */
+        inline double update_(double h)
+        {
+            double x_decay = std::exp(-h / tau_rec_); /// To be checked which implementation of exponential is being used
+            double u_decay = (tau_fac_ < 1.0e-10) ? 0.0 : std::exp(-h / tau_fac_); // branching
+            // now we compute spike number n+1
+            /// no forward dependency between next 2 statements
+            x_ = 1. + (x_ - x_ * u_ - 1.) * x_decay; // Eq. 5 from reference [3] ---> 2 Multiply + 3 adds + 1 assignment
+            u_ = U_ + u_ * (1. - U_) * u_decay; // Eq. 4 from [3] --> 2 Muliply + 2 adds + 1 assignment
+            return x_ * u_ * weight_;
+        }
+
         double weight_; //!< synapse weight
         double U_; //!< unit increment of a facilitating synapse
         double u_; //!< dynamic value of probability of release
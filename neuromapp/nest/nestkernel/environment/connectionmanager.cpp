@@ -9,6 +9,9 @@
 
 // Get OMP header if available
 #include "utils/omp/compatibility.h"
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
 
 namespace nest {
     connectionmanager::connectionmanager(po::variables_map const& vm):
@@ -18,11 +21,17 @@ namespace nest {
         const int num_threads = vm["nThreads"].as<int>();
         tVSConnector tmp( num_threads, tSConnector() );
         connections_.swap( tmp );
+        frozen_tables_.resize( num_threads );
+        frozen_.assign( num_threads, 0 );
     }
 
     void
     connectionmanager::send( thread t, index sgid, event& e )
     {
+      if ( frozen_[ t ] ) {
+        frozen_tables_[ t ].send( sgid, e );
+        return;
+      }
       if ( sgid < connections_[ t ].size() ) // probably test only fails, if there are no connections
         if ( connections_[ t ].get( sgid ) != 0 ) // only send, if connections exist
           connections_[ t ].get( sgid )->send( e );
@@ -31,6 +40,8 @@ namespace nest {
     void
     connectionmanager::connect(thread t, index s_gid, targetindex target)
     {
+        if ( frozen_[ t ] )
+            throw std::logic_error("connections of the thread are frozen");
         if (vm["model"].as<std::string>() == "tsodyks2") {
             const double delay = vm["delay"].as<double>();
             const double weight = vm["weight"].as<double>();
@@ -43,7 +54,9 @@ namespace nest {
             tsodyks2 syn(delay, weight, U, u, x, tau_rec, tau_fac, target);
 
             ConnectorBase* conn = validate_source_entry( t, s_gid);
-            ConnectorBase* c = add_connection<tsodyks2>( conn, syn );
+            //structure of arrays connectors (--soa)
+            ConnectorBase* c = vm.count("soa") ? add_soa_connection( conn, syn ) :
+                                                 add_connection<tsodyks2>( conn, syn );
             connections_[ t ].set( s_gid, c );
         }
         else {
@@ -51,6 +64,59 @@ namespace nest {
         }
     }
 
+    /*
+     * \fn connectionmanager::freeze(thread t)
+     * \brief compacts the connectors of the thread into a frozen_table,
+     * send() uses it from then on and connect() is not allowed anymore
+     * \param t thread, every thread freezes its own connections
+     */
+    void
+    connectionmanager::freeze( thread t )
+    {
+        if ( frozen_[ t ] )
+            return;
+        frozen_tables_[ t ].freeze( connections_[ t ], ncells );
+        frozen_[ t ] = 1;
+    }
+
+    /*
+     * \fn connectionmanager::num_connections(thread t)
+     * \brief number of connections stored by the thread
+     */
+    size_t
+    connectionmanager::num_connections( thread t ) const
+    {
+        if ( frozen_[ t ] )
+            return frozen_tables_[ t ].num_connections();
+        size_t n = 0;
+        for ( size_t s = 0; s < connections_[ t ].size(); s++ )
+            if ( connections_[ t ].test( s ) )
+                n += connections_[ t ].get( s )->get_size();
+        return n;
+    }
+
+    /*
+     * \fn connectionmanager::memory(thread t)
+     * \brief bytes used by the connections of the thread. Before freeze:
+     * the groups and pointers of the sparsetable plus, per connector, the
+     * ConnectorBase header and the synapses (allocator overhead and spare
+     * capacity not counted)
+     */
+    size_t
+    connectionmanager::memory( thread t ) const
+    {
+        if ( frozen_[ t ] )
+            return frozen_tables_[ t ].memory();
+        const tSConnector& table = connections_[ t ];
+        const size_t ngroups = ( table.size() + google::DEFAULT_SPARSEGROUP_SIZE - 1 ) / google::DEFAULT_SPARSEGROUP_SIZE;
+        size_t bytes = ngroups * sizeof( tSConnector::group_type )
+                     + table.num_nonempty() * sizeof( ConnectorBase* );
+        for ( size_t s = 0; s < table.size(); s++ )
+            if ( table.test( s ) )
+                bytes += sizeof( ConnectorBase ) + table.get( s )->get_size() * sizeof( tsodyks2 );
+        return bytes;
+    }
+
     ConnectorBase*
     connectionmanager::validate_source_entry( thread tid, index s_gid)
     {
@@ -109,5 +175,100 @@ namespace nest {
             }
         }
     }
-};
 
+    /*
+     * \fn count_or_scatter(...)
+     * \brief visits the local targets of the sources [begin, end): counts
+     * them per owning thread (lists == NULL) or writes them at pos
+     */
+    static void count_or_scatter(const std::vector<int>& sources, size_t begin, size_t end,
+                                 const environment::continousdistribution& neuro_dist,
+                                 const environment::presyn_maker& presyns,
+                                 size_t nthreads, size_t* pos,
+                                 std::vector< std::vector< std::pair<index, index> > >* lists)
+    {
+        for (size_t k = begin; k < end; k++) {
+            const int s_gid = sources[k];
+            const environment::presyn* ps[2] = {presyns.find_output(s_gid), presyns.find_input(s_gid)};
+            for (int j = 0; j < 2; j++) {
+                if (ps[j] == NULL)
+                    continue;
+                for (int i = 0; i < ps[j]->size(); ++i) {
+                    const unsigned int t_gid = (*ps[j])[i];
+                    if (!neuro_dist.isLocal(t_gid))
+                        continue;
+                    //thread owning the cell, continous distribution of the rank cells
+                    const size_t owner = environment::continousdistribution::owner(
+                        neuro_dist.global2local(t_gid), nthreads, neuro_dist.getlocalcells());
+                    if (lists == NULL)
+                        pos[owner]++;
+                    else
+                        (*lists)[owner][pos[owner]++] = std::make_pair(static_cast<index>(s_gid), static_cast<index>(t_gid));
+                }
+            }
+        }
+    }
+
+    /*
+     * \fn build_connections_inverted(const environment::continousdistribution& neuro_dist, const environment::presyn_maker& presyns, const std::vector<targetindex>& detectors_targetindex, connectionmanager& cm)
+     * \brief same connections as build_connections_from_neuron on every
+     * thread, but the presyn tables are inverted once into per thread target
+     * lists (parallel counting sort by owning thread), then every thread
+     * connects its own list. Only the gids of the tables are visited, once,
+     * instead of all the global cells by every thread. Call it outside of a
+     * parallel region, it opens one with a thread per table of cm.
+     * \param neuro_dist neuron distribution of the rank
+     * \param presyns network object from coreneuron
+     * \param detectors_targetindex vector of targetindexes to target nodes
+     * \param cm reference to connection manager
+     */
+    void build_connections_inverted(const environment::continousdistribution& neuro_dist,
+                                    const environment::presyn_maker& presyns,
+                                    const std::vector<targetindex>& detectors_targetindex,
+                                    connectionmanager& cm)
+    {
+        const int nthreads = cm.connections_.size();
+        std::vector<int> outputs, inputs, sources;
+        presyns.output_gids(outputs);
+        presyns.input_gids(inputs);
+        std::set_union(outputs.begin(), outputs.end(), inputs.begin(), inputs.end(),
+                       std::back_inserter(sources));
+
+        //pos[ i * nthreads + t ]: targets of the sources of thread i owned by
+        //thread t, then where thread i writes them in the list of t
+        std::vector<size_t> pos(nthreads * nthreads, 0);
+        std::vector< std::vector< std::pair<index, index> > > lists(nthreads);
+
+        #pragma omp parallel num_threads(nthreads)
+        {
+            const int thrd = omp_get_thread_num();
+            assert(omp_get_num_threads() == nthreads);
+            //contiguous slices keep the order of build_connections_from_neuron
+            const size_t begin = sources.size() * thrd / nthreads;
+            const size_t end = sources.size() * (thrd + 1) / nthreads;
+
+            count_or_scatter(sources, begin, end, neuro_dist, presyns, nthreads,
+                             &pos[thrd * nthreads], NULL);
+            #pragma omp barrier
+
+            size_t n = 0;
+            for (int i = 0; i < nthreads; i++) {
+                const size_t count = pos[i * nthreads + thrd];
+                pos[i * nthreads + thrd] = n;
+                n += count;
+            }
+            lists[thrd].resize(n);
+            #pragma omp barrier
+
+            count_or_scatter(sources, begin, end, neuro_dist, presyns, nthreads,
+                             &pos[thrd * nthreads], &lists);
+            #pragma omp barrier
+
+            for (size_t k = 0; k < lists[thrd].size(); k++) {
+                //connect to spikedetector (use mod function to avoid overflow)
+                targetindex target = detectors_targetindex[lists[thrd][k].second % detectors_targetindex.size()];
+                cm.connect(thrd, lists[thrd][k].first, target);
+            }
+        }
+    }
+};
@@ -10,6 +10,8 @@
 
 #include <boost/program_options.hpp>
 #include "nest/nestkernel/environment/connector_base.h"
+#include "nest/nestkernel/environment/soa_connector.h"
+#include "nest/nestkernel/environment/frozen_table.h"
 #include "nest/nestkernel/environment/event.h"
 #include "nest/nestkernel/environment/memory.h"
 #include "nest/libnestutil/sparsetable.h"
@@ -36,10 +38,41 @@ namespace nest
         ConnectorBase* validate_source_entry( thread tid, index s_gid);
     public:
         tVSConnector connections_;
+        std::vector< frozen_table > frozen_tables_;  // for all threads, after freeze
+        std::vector< int > frozen_;                 // true once the thread is frozen
 
         connectionmanager(po::variables_map const& vm);
         void connect(thread t, index s_gid, targetindex target);
         void send( thread t, index sgid, event& e );
+
+        /**
+         * same as send( t, sgid, e ) for targets of type NodeT: one virtual
+         * call per connector (none once frozen), none per synapse
+         */
+        template < typename NodeT >
+        inline void send( thread t, index sgid, spikeevent& e, const direct_target< NodeT >& targets )
+        {
+            if ( frozen_[ t ] )
+                frozen_tables_[ t ].send( sgid, e, targets );
+            else if ( sgid < connections_[ t ].size() && connections_[ t ].test( sgid ) )
+                connections_[ t ].get( sgid )->send( e, targets );
+        }
+
+        /**
+         * starts loading the connections of sgid into the cache, to send
+         * an event to them soon
+         */
+        inline void prefetch( thread t, index sgid ) const
+        {
+            if ( frozen_[ t ] )
+                frozen_tables_[ t ].prefetch( sgid );
+            else if ( sgid < connections_[ t ].size() && connections_[ t ].test( sgid ) )
+                NEST_PREFETCH( connections_[ t ].get( sgid ) );
+        }
+
+        void freeze( thread t );
+        size_t num_connections( thread t ) const;
+        size_t memory( thread t ) const;
     };
 
     void build_connections_from_neuron(const thread& thrd,
@@ -47,6 +80,11 @@ namespace nest
                                        const environment::presyn_maker& presyns,
                                        const std::vector<targetindex>& detectors_targetindex,
                                        connectionmanager& cm);
+
+    void build_connections_inverted(const environment::continousdistribution& neuro_dist,
+                                    const environment::presyn_maker& presyns,
+                                    const std::vector<targetindex>& detectors_targetindex,
+                                    connectionmanager& cm);
 };
 
 
@@ -58,6 +58,13 @@ public:
 
   virtual void send( event& e ) = 0;
 
+  /**
+   * same as send( e ) for targets of a known node type (direct_target):
+   * one virtual call per connector, none per synapse
+   */
+  virtual void send( spikeevent& e, const direct_target< spikedetector >& targets ) = 0;
+  virtual void send( spikeevent& e, const direct_target< spikecounter >& targets ) = 0;
+
   // destructor needed to delete connections
   virtual ~ConnectorBase(){};
 
@@ -87,11 +94,38 @@ class vector_like : public ConnectorBase
 public:
   virtual ConnectorBase& push_back (const ConnectionT& c) = 0;
   virtual size_t get_size () const = 0;
+  /** copy of the connection i (frozen_table) */
+  virtual ConnectionT get (size_t i) const = 0;
+};
+
+/**
+ * \class static_connector
+ * \brief implements the sends to direct targets of ConnectorBase for
+ * ConnectorT (CRTP): ConnectorT::send_direct is a template on the node type,
+ * with the synapse loop inlined for every node type
+ */
+template < typename ConnectorT, typename ConnectionT >
+class static_connector : public vector_like< ConnectionT >
+{
+public:
+  using vector_like< ConnectionT >::send;
+
+  void
+  send( spikeevent& e, const direct_target< spikedetector >& targets )
+  {
+    static_cast< ConnectorT* >( this )->send_direct( e, targets );
+  }
+
+  void
+  send( spikeevent& e, const direct_target< spikecounter >& targets )
+  {
+    static_cast< ConnectorT* >( this )->send_direct( e, targets );
+  }
 };
 
 // homogeneous connector containing K entries
 template < size_t K, typename ConnectionT >
-class Connector : public vector_like<ConnectionT>
+class Connector : public static_connector< Connector< K, ConnectionT >, ConnectionT >
 {
   ConnectionT C_[ K ];
 
@@ -121,6 +155,18 @@ public:
     ConnectorBase::set_t_lastspike( e.get_stamp().get_ms() );
   }
 
+  template < typename NodeT >
+  inline void
+  send_direct( spikeevent& e, const direct_target< NodeT >& targets )
+  {
+    const double t_lastspike = ConnectorBase::get_t_lastspike();
+    for ( size_t i = 0; i < K; i++ )
+      C_[ i ].send( e, t_lastspike, targets );
+    ConnectorBase::set_t_lastspike( e.get_stamp().get_ms() );
+  }
+
+  using static_connector< Connector< K, ConnectionT >, ConnectionT >::send;
+
   /**
    * Add a connection to the connector
    * @param c the connection to add.
@@ -137,6 +183,8 @@ public:
    */
   size_t get_size() const{ return K; }
 
+  ConnectionT get( size_t i ) const{ return C_[ i ]; }
+
   /**
    * Getter for the connection container, C_
    */
@@ -150,7 +198,7 @@ public:
 //check ...
 // homogeneous connector containing 1 entry (specialization to define constructor)
 template < typename ConnectionT >
-class Connector< 1, ConnectionT > : public vector_like<ConnectionT>
+class Connector< 1, ConnectionT > : public static_connector< Connector< 1, ConnectionT >, ConnectionT >
 {
   ConnectionT C_[ 1 ];
 
@@ -173,6 +221,16 @@ public:
     ConnectorBase::set_t_lastspike( e.get_stamp().get_ms() );
   }
 
+  template < typename NodeT >
+  inline void
+  send_direct( spikeevent& e, const direct_target< NodeT >& targets )
+  {
+    C_[ 0 ].send( e, ConnectorBase::get_t_lastspike(), targets );
+    ConnectorBase::set_t_lastspike( e.get_stamp().get_ms() );
+  }
+
+  using static_connector< Connector< 1, ConnectionT >, ConnectionT >::send;
+
   ConnectorBase& push_back( const ConnectionT& c )
   {
     return *suicide_and_resurrect< Connector< 2, ConnectionT > >( this, c );
@@ -185,13 +243,15 @@ public:
   }
 
   size_t get_size() const{ return 1; }
+
+  ConnectionT get( size_t i ) const{ return C_[ i ]; }
 };
 
 // homogeneous connector containing >=K_CUTOFF entries
 // specialization to define recursion termination for push_back
 // internally use a normal vector to store elements
 template < typename ConnectionT >
-class Connector< K_CUTOFF, ConnectionT > : public vector_like<ConnectionT>
+class Connector< K_CUTOFF, ConnectionT > : public static_connector< Connector< K_CUTOFF, ConnectionT >, ConnectionT >
 {
   std::vector< ConnectionT > C_;
 
@@ -230,7 +290,23 @@ public:
     ConnectorBase::set_t_lastspike( e.get_stamp().get_ms() );
   }
 
+  template < typename NodeT >
+  inline void
+  send_direct( spikeevent& e, const direct_target< NodeT >& targets )
+  {
+    const double t_lastspike = ConnectorBase::get_t_lastspike();
+    const size_t n = C_.size();
+    ConnectionT* C = &C_[ 0 ];
+    for ( size_t i = 0; i < n; i++ )
+      C[ i ].send( e, t_lastspike, targets );
+    ConnectorBase::set_t_lastspike( e.get_stamp().get_ms() );
+  }
+
+  using static_connector< Connector< K_CUTOFF, ConnectionT >, ConnectionT >::send;
+
   size_t get_size() const{ return C_.size(); }
+
+  ConnectionT get( size_t i ) const{ return C_[ i ]; }
 };
 
 
@@ -6,6 +6,7 @@
  */
 
 #include "nest/nestkernel/environment/event.h"
+#include "nest/nestkernel/environment/node.h"
 
 void nest::spikeevent::operator()()
 {
@@ -32,8 +32,6 @@
 #include <limits.h>
 #include <limits>
 
-#include "nest/nestkernel/environment/node.h"
-
 
 namespace nest
 {
@@ -0,0 +1,183 @@
+/*
+ * Neuromapp - frozen_table.h, Copyright (c), 2015,
+ * Till Schumann - Swiss Federal Institute of technology in Lausanne,
+ * till.schumann@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/nest/nestkernel/environment/frozen_table.h
+ * \brief compressed source table of one thread, built once the network
+ * is connected
+ */
+
+#ifndef FROZEN_TABLE_H
+#define FROZEN_TABLE_H
+
+#include <vector>
+#include <cassert>
+
+#include "nest/nestkernel/environment/connector_base.h"
+#include "nest/libnestutil/sparsetable.h"
+#include "nest/models/tsodyks2.h"
+
+#if defined( __GNUC__ )
+#define NEST_PREFETCH( p ) __builtin_prefetch( p )
+#else
+#define NEST_PREFETCH( p )
+#endif
+
+namespace nest
+{
+
+/**
+ * \class frozen_table
+ * \brief the connections of all the sources of a thread in one contiguous
+ * arena, indexed by source gid (CSR): the synapses of s_gid are
+ * synapses_[ offsets_[ s_gid ] ] to synapses_[ offsets_[ s_gid + 1 ] - 1 ].
+ * Replaces the sparsetable of connectors once no connection is added:
+ * one offset lookup per spike instead of a sparsetable group lookup and a
+ * pointer chase into a heap connector, and no virtual call.
+ */
+class frozen_table
+{
+  /// first synapse of every source, ncells + 1 entries
+  std::vector< unsigned int > offsets_;
+  std::vector< tsodyks2 > synapses_;
+  /// last spike time of every source (ConnectorBase::t_lastspike_)
+  std::vector< double > t_lastspike_;
+
+public:
+  /**
+   * \fn void freeze( google::sparsetable< ConnectorBase* >& connectors, size_t ncells )
+   * \brief copies the connections and spike times of the connectors, then
+   * destroys the connectors and empties the table. The memory of the
+   * connectors is reused by the slab allocator, else given back with the
+   * pool (pool_env).
+   * \param connectors the table of one thread, tsodyks2 connectors only
+   * \param ncells number of cells in the network
+   */
+  void
+  freeze( google::sparsetable< ConnectorBase* >& connectors, size_t ncells )
+  {
+    offsets_.assign( ncells + 1, 0 );
+    t_lastspike_.assign( ncells, 0. );
+    size_t n = 0;
+    for ( size_t s = 0; s < connectors.size() && s < ncells; s++ )
+      if ( connectors.test( s ) )
+        n += connectors.get( s )->get_size();
+    assert( n <= 0xffffffffu );
+    synapses_.clear();
+    synapses_.reserve( n );
+
+    for ( size_t s = 0; s < ncells; s++ )
+    {
+      offsets_[ s ] = synapses_.size();
+      if ( s < connectors.size() && connectors.test( s ) )
+      {
+        const vector_like< tsodyks2 >* c =
+          static_cast< const vector_like< tsodyks2 >* >( connectors.get( s ) );
+        for ( size_t i = 0; i < c->get_size(); i++ )
+          synapses_.push_back( c->get( i ) );
+        t_lastspike_[ s ] = c->get_t_lastspike();
+        connectors.get( s )->~ConnectorBase();
+        poormansallocpool[ omp_get_thread_num() ].dealloc( connectors.get( s ) );
+      }
+    }
+    offsets_[ ncells ] = synapses_.size();
+    google::sparsetable< ConnectorBase* >().swap( connectors );
+  }
+
+  /**
+   * \fn void send( index sgid, event& e )
+   * \brief same as ConnectorBase::send for the connections of sgid
+   */
+  inline void
+  send( index sgid, event& e )
+  {
+    if ( sgid + 1 >= offsets_.size() )
+      return;
+    const double t_lastspike = t_lastspike_[ sgid ];
+    for ( unsigned int i = offsets_[ sgid ]; i < offsets_[ sgid + 1 ]; i++ )
+      synapses_[ i ].send( e, t_lastspike );
+    t_lastspike_[ sgid ] = e.get_stamp().get_ms();
+  }
+
+  /**
+   * \fn void send( index sgid, spikeevent& e, const direct_target< NodeT >& targets )
+   * \brief same as send( sgid, e ) for targets of type NodeT, no virtual call
+   */
+  template < typename NodeT >
+  inline void
+  send( index sgid, spikeevent& e, const direct_target< NodeT >& targets )
+  {
+    if ( sgid + 1 >= offsets_.size() )
+      return;
+    const double t_lastspike = t_lastspike_[ sgid ];
+    for ( unsigned int i = offsets_[ sgid ]; i < offsets_[ sgid + 1 ]; i++ )
+      synapses_[ i ].send( e, t_lastspike, targets );
+    t_lastspike_[ sgid ] = e.get_stamp().get_ms();
+  }
+
+  /**
+   * \fn void prefetch( index sgid ) const
+   * \brief starts loading the first connection of sgid into the cache
+   */
+  inline void
+  prefetch( index sgid ) const
+  {
+    if ( sgid + 1 < offsets_.size() && offsets_[ sgid ] < synapses_.size() )
+      NEST_PREFETCH( &synapses_[ offsets_[ sgid ] ] );
+  }
+
+  /**
+   * \fn size_t get_size( index sgid ) const
+   * \brief number of connections of the source sgid
+   */
+  size_t
+  get_size( index sgid ) const
+  {
+    return sgid + 1 < offsets_.size() ? offsets_[ sgid + 1 ] - offsets_[ sgid ] : 0;
+  }
+
+  /**
+   * \fn const tsodyks2& get( index sgid, size_t i ) const
+   * \brief the connection i of the source sgid
+   */
+  const tsodyks2&
+  get( index sgid, size_t i ) const
+  {
+    return synapses_[ offsets_[ sgid ] + i ];
+  }
+
+  size_t num_connections() const{ return synapses_.size(); }
+
+  /**
+   * \fn size_t memory() const
+   * \brief bytes used by the offsets, the synapses and the spike times
+   */
+  size_t
+  memory() const
+  {
+    return offsets_.capacity() * sizeof( unsigned int )
+      + synapses_.capacity() * sizeof( tsodyks2 )
+      + t_lastspike_.capacity() * sizeof( double );
+  }
+};
+
+} // of namespace nest
+
+#endif
@@ -30,6 +30,7 @@
 #include <algorithm>
 // Get OMP header if available
 #include "utils/omp/compatibility.h"
+#include "nest/nestkernel/environment/slab_allocator.h"
 
 namespace nest{
 
@@ -71,7 +72,7 @@ namespace nest{
         };
 
     public:
-        PoorMansAllocator(): states(false){
+        PoorMansAllocator(): states(false), slab(false){
         }
 
         ~PoorMansAllocator(){
@@ -94,6 +95,8 @@ namespace nest{
         }
 
         void destruct(){
+            if(slab)
+                slab_.release();
 
             if(!states) {
                 if (save_ptr.size() > 0)
@@ -107,6 +110,9 @@ namespace nest{
         }
 
         void* alloc( size_t obj_size ){
+            if(slab)
+                return slab_.alloc(obj_size);
+
             char* ptr = head_;
 
             if(!states){
@@ -130,6 +136,18 @@ namespace nest{
             return ptr;
         }
 
+        /** gives the memory of a dead object back, slab allocator only:
+         the other modes keep it until destruct() */
+        void dealloc( void* ptr ){
+            if(slab)
+                slab_.dealloc(ptr);
+        }
+
+        /** statistics of the slab allocator */
+        const slab_stats& stats() const{
+            return slab_.stats();
+        }
+
         /** get function for the tests only*/
         size_t capacity() const{
             return capacity_;
@@ -145,7 +163,10 @@ namespace nest{
 
         /** states */
         bool states;
+        /** thread local slab allocator with size classes, has priority over states */
+        bool slab;
     private:
+        SlabAllocator slab_;
         /** I am not guilty od the NEST design */
         std::vector<void*> save_ptr;
         /**
@@ -201,13 +222,14 @@ namespace nest{
     class pool_env{
         const int num_threads_;
     public:
-        pool_env(const int& num_threads=1, bool pool=false): num_threads_(num_threads)
+        pool_env(const int& num_threads=1, bool pool=false, bool slab=false): num_threads_(num_threads)
         {
             poormansallocpool.resize(num_threads_);
 
             #pragma omp parallel for schedule(static, 1)
              for (int thrd=0; thrd<num_threads_; thrd++) {
                 poormansallocpool[thrd].states = pool;
+                poormansallocpool[thrd].slab = slab;
                 poormansallocpool[thrd].init();
             }
         }
@@ -226,6 +248,13 @@ namespace nest{
         const int thrd = omp_get_thread_num();
 
         Tnew* p = NULL;
+        if ( poormansallocpool[thrd].slab ) { // thread local, the old connector is reused
+            p = new ( poormansallocpool[thrd].alloc( sizeof( Tnew ) ) )
+            Tnew(*connector, connection );
+            connector->~Told();
+            poormansallocpool[thrd].dealloc( connector );
+            return p;
+        }
        #pragma omp critical // not thread safe!!
         {
         p = new ( poormansallocpool[thrd].alloc( sizeof( Tnew ) ) )
@@ -8,13 +8,4 @@
 
 #include "nest/nestkernel/environment//node.h"
 
-void nest::spikedetector::handle( nest::spikeevent& e )
-{
-    spikes.push_back(e);
-}
-
-void nest::spikecounter::handle( nest::spikeevent& e )
-{
-    num += 1;
-    sumtime += e.get_stamp().get_ms();
-}
+// the handlers are inline in node.h (direct_target)
@@ -28,6 +28,7 @@
 #define NODE_H_
 
 #include <vector>
+#include <cassert>
 #include "nest/nestkernel/environment//event.h"
 
 
@@ -93,7 +94,10 @@ typedef void Subnet;
             spikes.reserve(1024);
         }
         std::vector<spikeevent> spikes;
-        void handle( spikeevent& e );
+        inline void handle( spikeevent& e )
+        {
+            spikes.push_back(e);
+        }
     };
 
     class spikecounter : public node
@@ -103,7 +107,48 @@ typedef void Subnet;
         double sumtime;
         spikecounter(): num(0), sumtime(0){
         }
-        void handle( spikeevent& e );
+        inline void handle( spikeevent& e )
+        {
+            num += 1;
+            sumtime += e.get_stamp().get_ms();
+        }
+    };
+
+    /**
+     * \class direct_target
+     * \brief targets of the synapses as direct handles: the nodes of type
+     * NodeT were registered in a row with the scheduler (scheduler::add_node),
+     * the node of a targetindex is found by address arithmetic instead of the
+     * node* table of the scheduler, and handle() is called without virtual
+     * dispatch (inlined). The connectors offer send() for the node types of
+     * this file.
+     */
+    template < typename NodeT >
+    class direct_target
+    {
+    private:
+        NodeT* nodes_;
+        index first_;
+
+    public:
+        /**
+         * \param nodes the nodes
+         * \param targets their targetindex, consecutive
+         */
+        template < typename TargetIndexT >
+        direct_target( std::vector< NodeT >& nodes, const std::vector< TargetIndexT >& targets ):
+            nodes_( nodes.empty() ? NULL : &nodes[ 0 ] ),
+            first_( targets.empty() ? 0 : targets[ 0 ] )
+        {
+            assert( nodes.size() == targets.size() );
+            for ( size_t i = 0; i < targets.size(); ++i )
+                assert( static_cast< index >( targets[ i ] ) == first_ + i );
+        }
+
+        inline NodeT& operator[]( index target ) const
+        {
+            return nodes_[ target - first_ ];
+        }
     };
 };
 
@@ -0,0 +1,246 @@
+/*
+ * Neuromapp - slab_allocator.h, Copyright (c), 2015,
+ * Till Schumann - Swiss Federal Institute of technology in Lausanne,
+ * till.schumann@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/nest/nestkernel/environment/slab_allocator.h
+ * \brief thread local slab allocator with size classes for the connectors
+ */
+
+#ifndef SLAB_ALLOCATOR_H_
+#define SLAB_ALLOCATOR_H_
+
+#include <stdlib.h>
+#include <new>
+#include <algorithm>
+
+namespace nest{
+
+    /** what the slab allocator holds and did */
+    struct slab_stats{
+        slab_stats(): live_bytes(0), slab_bytes(0), peak_live_bytes(0), peak_slab_bytes(0),
+                      nallocs(0), nfrees(0), nreused(0), nslabs_reused(0){}
+        /// bytes of the live objects, rounded to their size class
+        size_t live_bytes;
+        /// bytes of the slabs taken from the OS
+        size_t slab_bytes;
+        size_t peak_live_bytes;
+        size_t peak_slab_bytes;
+        size_t nallocs;
+        size_t nfrees;
+        /// allocations served by a free list
+        size_t nreused;
+        /// empty slabs given to a size class again
+        size_t nslabs_reused;
+
+        /** part of the slabs not used by live objects */
+        double fragmentation() const{
+            return slab_bytes ? 1. - static_cast<double>(live_bytes) / slab_bytes : 0.;
+        }
+    };
+
+    /**
+     * \class SlabAllocator
+     * \brief allocator of one thread for the connectors. Objects are rounded
+     * up to a size class (multiple of granularity, one class per
+     * Connector<K> size in practice). Every slab is slab_size bytes, aligned
+     * on its size so that the slab of an object is found from its address,
+     * and serves one size class: its freed blocks go to its free list, and
+     * once all of them are free the slab goes to the empty list, from where
+     * any size class takes it again. The connectors left behind by
+     * suicide_and_resurrect are therefore reused by the next connectors of
+     * the same size instead of piling up during the network construction.
+     *
+     * Objects must be freed by the thread that allocated them. Like the
+     * PoorMansAllocator, the memory is only given back by release() (no
+     * destructor: the allocators are copied into a vector).
+     */
+    class SlabAllocator
+    {
+    public:
+        enum { slab_size = 65536,
+               granularity = 16,
+               max_object_size = 1024,
+               nclasses = max_object_size / granularity };
+
+    private:
+        /** header at the beginning of every slab */
+        struct slab
+        {
+            slab* prev_;     // list of the partial slabs of the class, or empty list
+            slab* next_;
+            slab* next_all_; // all the slabs, for release()
+            size_t class_;
+            size_t live_;
+            char* bump_;     // first block never allocated
+            void* free_;     // freed blocks
+            bool in_partial_;
+        };
+
+        enum { header_size = ( ( sizeof( slab ) + 63 ) / 64 ) * 64 };
+
+    public:
+        SlabAllocator(): all_(NULL), empty_(NULL){
+            std::fill(partial_, partial_ + nclasses, static_cast<slab*>(NULL));
+        }
+
+        /**
+         * \fn void* alloc(size_t obj_size)
+         * \brief a block of the size class of obj_size, from the free list
+         * of a partial slab, else never used space of that slab, else a new
+         * (or empty) slab
+         */
+        void* alloc(size_t obj_size){
+            if(obj_size > max_object_size)
+                throw std::bad_alloc();
+            const size_t c = obj_size ? (obj_size - 1) / granularity : 0;
+            const size_t block = (c + 1) * granularity;
+            slab* s = partial_[c];
+            if(s == NULL){
+                s = new_slab(c);
+                push_partial(s);
+            }
+
+            void* p;
+            if(s->free_ != NULL){
+                p = s->free_;
+                s->free_ = *reinterpret_cast<void**>(p);
+                stats_.nreused++;
+            }
+            else{
+                p = s->bump_;
+                s->bump_ += block;
+            }
+            s->live_++;
+            if(s->free_ == NULL && s->bump_ + block > reinterpret_cast<char*>(s) + slab_size)
+                remove_partial(s); // full
+
+            stats_.nallocs++;
+            stats_.live_bytes += block;
+            stats_.peak_live_bytes = std::max(stats_.peak_live_bytes, stats_.live_bytes);
+            return p;
+        }
+
+        /**
+         * \fn void dealloc(void* ptr)
+         * \brief gives a block back to the free list of its slab
+         */
+        void dealloc(void* ptr){
+            if(ptr == NULL)
+                return;
+            slab* s = slab_of(ptr);
+            *reinterpret_cast<void**>(ptr) = s->free_;
+            s->free_ = ptr;
+            s->live_--;
+            stats_.nfrees++;
+            stats_.live_bytes -= (s->class_ + 1) * granularity;
+            if(s->live_ == 0){
+                if(s->in_partial_)
+                    remove_partial(s);
+                s->next_ = empty_;
+                empty_ = s;
+            }
+            else if(!s->in_partial_){
+                push_partial(s);
+            }
+        }
+
+        /**
+         * \fn void release()
+         * \brief frees all the slabs, the live objects included
+         */
+        void release(){
+            while(all_ != NULL){
+                slab* next = all_->next_all_;
+                free(all_);
+                all_ = next;
+            }
+            empty_ = NULL;
+            std::fill(partial_, partial_ + nclasses, static_cast<slab*>(NULL));
+            const size_t peak_live = stats_.peak_live_bytes;
+            const size_t peak_slab = stats_.peak_slab_bytes;
+            stats_ = slab_stats();
+            stats_.peak_live_bytes = peak_live;
+            stats_.peak_slab_bytes = peak_slab;
+        }
+
+        const slab_stats& stats() const{
+            return stats_;
+        }
+
+    private:
+        static inline slab* slab_of(void* ptr){
+            return reinterpret_cast<slab*>(reinterpret_cast<size_t>(ptr) & ~(static_cast<size_t>(slab_size) - 1));
+        }
+
+        slab* new_slab(size_t c){
+            slab* s = empty_;
+            if(s != NULL){
+                empty_ = s->next_;
+                stats_.nslabs_reused++;
+            }
+            else{
+                void* mem = NULL;
+                if(posix_memalign(&mem, slab_size, slab_size) != 0)
+                    throw std::bad_alloc();
+                s = static_cast<slab*>(mem);
+                s->next_all_ = all_;
+                all_ = s;
+                stats_.slab_bytes += slab_size;
+                stats_.peak_slab_bytes = std::max(stats_.peak_slab_bytes, stats_.slab_bytes);
+            }
+            s->prev_ = NULL;
+            s->next_ = NULL;
+            s->class_ = c;
+            s->live_ = 0;
+            s->bump_ = reinterpret_cast<char*>(s) + header_size;
+            s->free_ = NULL;
+            s->in_partial_ = false;
+            return s;
+        }
+
+        void push_partial(slab* s){
+            s->prev_ = NULL;
+            s->next_ = partial_[s->class_];
+            if(s->next_ != NULL)
+                s->next_->prev_ = s;
+            partial_[s->class_] = s;
+            s->in_partial_ = true;
+        }
+
+        void remove_partial(slab* s){
+            if(s->prev_ != NULL)
+                s->prev_->next_ = s->next_;
+            else
+                partial_[s->class_] = s->next_;
+            if(s->next_ != NULL)
+                s->next_->prev_ = s->prev_;
+            s->prev_ = NULL;
+            s->next_ = NULL;
+            s->in_partial_ = false;
+        }
+
+        slab* all_;
+        slab* empty_;
+        slab* partial_[nclasses];
+        slab_stats stats_;
+    };
+
+}
+#endif /* SLAB_ALLOCATOR_H_ */
@@ -0,0 +1,219 @@
+/*
+ * Neuromapp - soa_connector.h, Copyright (c), 2015,
+ * Till Schumann - Swiss Federal Institute of technology in Lausanne,
+ * till.schumann@epfl.ch,
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ */
+
+/**
+ * @file neuromapp/nest/nestkernel/environment/soa_connector.h
+ * \brief structure of arrays connector of tsodyks2 synapses
+ */
+
+#ifndef SOA_CONNECTOR_H
+#define SOA_CONNECTOR_H
+
+#include <cmath>
+#include <vector>
+#include <cassert>
+
+#include "nest/nestkernel/environment/connector_base.h"
+#include "nest/nestkernel/environment/scheduler.h"
+#include "nest/nestkernel/environment/memory.h"
+#include "nest/models/tsodyks2.h"
+
+namespace nest
+{
+
+/**
+ * \class SoAConnector
+ * \brief homogeneous connector of the tsodyks2 synapses of one source, every
+ * parameter in its own contiguous array. send() updates x and u of all the
+ * targets in one loop without dependencies between iterations (vectorizable),
+ * then delivers the events. The decay factors are computed once per spike
+ * while all the synapses share tau_rec and tau_fac (the common case: the
+ * parameters of a projection), else once per synapse in a separate loop.
+ */
+class SoAConnector : public static_connector< SoAConnector, tsodyks2 >
+{
+  std::vector< double > weight_;
+  std::vector< double > U_;
+  std::vector< double > u_;
+  std::vector< double > x_;
+  std::vector< double > tau_rec_;
+  std::vector< double > tau_fac_;
+  std::vector< targetindex > target_;
+  std::vector< long > delay_;
+  /// weights of the current spike, then per synapse decays if not shared
+  std::vector< double > w_;
+  std::vector< double > x_decay_;
+  std::vector< double > u_decay_;
+  /// true while all the synapses have the same tau_rec and tau_fac
+  bool shared_tau_;
+
+public:
+  SoAConnector( const tsodyks2& c )
+    : shared_tau_( true )
+  {
+    push_back( c );
+  }
+
+  ~SoAConnector()
+  {}
+
+  /**
+   * Add a connection to the connector, in place
+   * @param c the connection to add.
+   * @return this connector
+   */
+  ConnectorBase& push_back( const tsodyks2& c )
+  {
+    if ( !tau_rec_.empty() )
+      shared_tau_ = shared_tau_ && c.tau_rec() == tau_rec_[ 0 ] && c.tau_fac() == tau_fac_[ 0 ];
+    weight_.push_back( c.weight() );
+    U_.push_back( c.U() );
+    u_.push_back( c.u() );
+    x_.push_back( c.x() );
+    tau_rec_.push_back( c.tau_rec() );
+    tau_fac_.push_back( c.tau_fac() );
+    target_.push_back( c.target_ );
+    delay_.push_back( c.delay() );
+    w_.push_back( 0. );
+    return *this;
+  }
+
+  void
+  send( event& e ) // , NEST: thread t  not necessary for MiniApp (see synapse)
+  {
+    update_weights_( e.get_stamp().get_ms() - ConnectorBase::get_t_lastspike() );
+    const double* w = &w_[ 0 ];
+    for ( size_t i = 0; i < w_.size(); i++ )
+    {
+      node* target_node = scheduler::get_target( target_[ i ] );
+      assert( target_node != NULL );
+      e.set_receiver( target_node );
+      e.set_weight( w[ i ] );
+      e();
+    }
+    ConnectorBase::set_t_lastspike( e.get_stamp().get_ms() );
+  }
+
+  template < typename NodeT >
+  inline void
+  send_direct( spikeevent& e, const direct_target< NodeT >& targets )
+  {
+    update_weights_( e.get_stamp().get_ms() - ConnectorBase::get_t_lastspike() );
+    const double* w = &w_[ 0 ];
+    const targetindex* target = &target_[ 0 ];
+    for ( size_t i = 0; i < w_.size(); i++ )
+    {
+      NodeT& target_node = targets[ target[ i ] ];
+      e.set_receiver( &target_node );
+      e.set_weight( w[ i ] );
+      target_node.NodeT::handle( e );
+    }
+    ConnectorBase::set_t_lastspike( e.get_stamp().get_ms() );
+  }
+
+  using static_connector< SoAConnector, tsodyks2 >::send;
+
+private:
+  /**
+   * updates x and u of all the synapses h ms after the last spike, and
+   * their weights w_
+   */
+  void
+  update_weights_( const double h )
+  {
+    const size_t n = weight_.size();
+    double* x = &x_[ 0 ];
+    double* u = &u_[ 0 ];
+    double* w = &w_[ 0 ];
+    const double* U = &U_[ 0 ];
+    const double* weight = &weight_[ 0 ];
+
+    // same update as tsodyks2::send, x uses u before its update
+    if ( shared_tau_ )
+    {
+      const double x_decay = std::exp( -h / tau_rec_[ 0 ] );
+      const double u_decay = ( tau_fac_[ 0 ] < 1.0e-10 ) ? 0.0 : std::exp( -h / tau_fac_[ 0 ] );
+      for ( size_t i = 0; i < n; i++ )
+      {
+        const double xi = 1. + ( x[ i ] - x[ i ] * u[ i ] - 1. ) * x_decay;
+        const double ui = U[ i ] + u[ i ] * ( 1. - U[ i ] ) * u_decay;
+        x[ i ] = xi;
+        u[ i ] = ui;
+        w[ i ] = xi * ui * weight[ i ];
+      }
+    }
+    else
+    {
+      x_decay_.resize( n );
+      u_decay_.resize( n );
+      for ( size_t i = 0; i < n; i++ )
+      {
+        x_decay_[ i ] = std::exp( -h / tau_rec_[ i ] );
+        u_decay_[ i ] = ( tau_fac_[ i ] < 1.0e-10 ) ? 0.0 : std::exp( -h / tau_fac_[ i ] );
+      }
+      const double* x_decay = &x_decay_[ 0 ];
+      const double* u_decay = &u_decay_[ 0 ];
+      for ( size_t i = 0; i < n; i++ )
+      {
+        const double xi = 1. + ( x[ i ] - x[ i ] * u[ i ] - 1. ) * x_decay[ i ];
+        const double ui = U[ i ] + u[ i ] * ( 1. - U[ i ] ) * u_decay[ i ];
+        x[ i ] = xi;
+        u[ i ] = ui;
+        w[ i ] = xi * ui * weight[ i ];
+      }
+    }
+  }
+
+public:
+
+  /**
+   * Getter for the connection i, as a tsodyks2
+   */
+  tsodyks2
+  get( size_t i ) const
+  {
+    return tsodyks2( delay_[ i ], weight_[ i ], U_[ i ], u_[ i ], x_[ i ],
+      tau_rec_[ i ], tau_fac_[ i ], target_[ i ] );
+  }
+
+  /**
+   * true if the decay factors are computed once per spike
+   */
+  bool shared_tau() const{ return shared_tau_; }
+
+  size_t get_size() const{ return weight_.size(); }
+};
+
+/*
+ * \fn ConnectorBase* add_soa_connection( ConnectorBase* conn, const tsodyks2& syn )
+ * \brief add connection to a SoAConnector, same as add_connection
+ * \param conn pointer to ConnectorBase, NULL or a SoAConnector
+ * \param syn new synapse object
+ */
+inline ConnectorBase* add_soa_connection( ConnectorBase* conn, const tsodyks2& syn )
+{
+  if ( conn == NULL )
+    return allocate< SoAConnector >( syn );
+  return &static_cast< SoAConnector* >( conn )->push_back( syn );
+}
+
+} // of namespace nest
+
+#endif
@@ -20,24 +20,35 @@ eventdelivermanager::eventdelivermanager(connectionmanager& cn, const unsigned i
     num_threads_(num_threads),
     num_processes_(num_ranks),
     displacements_(num_ranks),
-    spike_register_(num_threads, std::vector< std::vector< uint_t > >(min_delay)),
-    cn_(cn)
+    spike_register_(num_threads, spike_register(min_delay)),
+    cn_(cn),
+    targets_(NULL),
+    predictive_(false),
+    collocated_(false),
+    delivery_(num_threads),
+    sorted_(false)
 {
   configure_spike_buffers();
 }
 
+/*
+ * sizes the send buffer for the spikes of all the threads and sets the
+ * start of the section of every thread
+ */
 void
-eventdelivermanager::collocate_buffers_()
+eventdelivermanager::size_buffers_()
 {
     // count number of spikes in registers
     int num_spikes = 0;
     int num_grid_spikes = 0;
 
-    std::vector< std::vector< std::vector< uint_t > > >::iterator i;
-    std::vector< std::vector< uint_t > >::iterator j;
-        for ( i = spike_register_.begin(); i != spike_register_.end(); ++i )
-            for ( j = i->begin(); j != i->end(); ++j )
-                num_grid_spikes += j->size();
+    sections_.resize( num_threads_ + 1 );
+    sections_[ 0 ] = 0;
+    for ( int thrd = 0; thrd < num_threads_; ++thrd )
+    {
+        num_grid_spikes += spike_register_[ thrd ].size();
+        sections_[ thrd + 1 ] = sections_[ thrd ] + spike_register_[ thrd ].size() + min_delay_;
+    }
 
     //skip num_offgrid_spikes
     //skip uintsize_secondary_events
@@ -52,23 +63,12 @@ eventdelivermanager::collocate_buffers_()
 
     if ( num_spikes + ( num_threads_ * min_delay_ ) > static_cast< uint_t >( send_buffer_size_ ) )
           local_grid_spikes_.resize( num_spikes + ( min_delay_ * num_threads_ ) , 0 );
-    else if ( local_grid_spikes_.size() < static_cast< uint_t >( send_buffer_size_ ) )
+    else if ( local_grid_spikes_.size() != static_cast< uint_t >( send_buffer_size_ ) )
           local_grid_spikes_.resize(send_buffer_size_, 0 );
 
-    // collocate the entries of spike_registers into local_grid_spikes__
-    std::vector< uint_t >::iterator pos = local_grid_spikes_.begin();
-    for ( i = spike_register_.begin(); i != spike_register_.end(); ++i )
-        for ( j = i->begin(); j != i->end(); ++j )
-        {
-          pos = std::copy( j->begin(), j->end(), pos );
-          *pos = comm_marker_;
-          ++pos;
-        }
-
-    // remove old spikes from the spike_register_
-    for ( i = spike_register_.begin(); i != spike_register_.end(); ++i )
-      for ( j = i->begin(); j != i->end(); ++j )
-        j->clear();
+    // the last entry is never used by the spikes (+2 above)
+    if ( predictive_ && local_grid_spikes_.size() == static_cast< uint_t >( send_buffer_size_ ) )
+        local_grid_spikes_.back() = num_spikes + ( min_delay_ * num_threads_ );
 
     //not sure if needed
     //// end marker after last secondary event
@@ -78,11 +78,106 @@ eventdelivermanager::collocate_buffers_()
     //write_to_comm_buffer( done, pos );
 }
 
+void
+eventdelivermanager::collocate_buffers_()
+{
+    size_buffers_();
+
+    // collocate the entries of spike_registers into local_grid_spikes__
+    for ( int thrd = 0; thrd < num_threads_; ++thrd )
+    {
+        spike_register_[ thrd ].collocate( &local_grid_spikes_[ sections_[ thrd ] ], comm_marker_ );
+        spike_register_[ thrd ].clear();
+    }
+}
+
+void
+eventdelivermanager::collocate_events( thread thrd )
+{
+    if ( targets_ != NULL )
+        return;
+
+    #pragma omp single
+    size_buffers_();
+
+    spike_register_[ thrd ].collocate( &local_grid_spikes_[ sections_[ thrd ] ], comm_marker_ );
+    spike_register_[ thrd ].clear();
+
+    #pragma omp single
+    collocated_ = true;
+}
+
+/*
+ * same layout as collocate_buffers_, once per destination process: the
+ * section of process pid only holds the spikes of the sources with
+ * targets on pid, the markers are kept for every thread and lag.
+ */
+void
+eventdelivermanager::collocate_sections_()
+{
+    send_counts_.assign( num_processes_, num_threads_ * min_delay_ );
+
+    for ( int thrd = 0; thrd < num_threads_; ++thrd )
+        for ( long lag = 0; lag < min_delay_; ++lag )
+        {
+            const uint_t* gids = spike_register_[ thrd ].begin( lag );
+            for ( size_t k = 0; k < spike_register_[ thrd ].size( lag ); ++k )
+                for ( const int* r = targets_->begin( gids[ k ] ); r != targets_->end( gids[ k ] ); ++r )
+                    send_counts_[ *r ]++;
+        }
+
+    std::vector< int > pos( num_processes_, 0 );
+    for ( int pid = 1; pid < num_processes_; ++pid )
+        pos[ pid ] = pos[ pid - 1 ] + send_counts_[ pid - 1 ];
+    local_grid_spikes_.resize( pos[ num_processes_ - 1 ] + send_counts_[ num_processes_ - 1 ] );
+
+    for ( int thrd = 0; thrd < num_threads_; ++thrd )
+    {
+        for ( long lag = 0; lag < min_delay_; ++lag )
+        {
+            const uint_t* gids = spike_register_[ thrd ].begin( lag );
+            for ( size_t k = 0; k < spike_register_[ thrd ].size( lag ); ++k )
+                for ( const int* r = targets_->begin( gids[ k ] ); r != targets_->end( gids[ k ] ); ++r )
+                    local_grid_spikes_[ pos[ *r ]++ ] = gids[ k ];
+            for ( int pid = 0; pid < num_processes_; ++pid )
+                local_grid_spikes_[ pos[ pid ]++ ] = comm_marker_;
+        }
+        spike_register_[ thrd ].clear();
+    }
+}
+
 void
 eventdelivermanager::gather_events()
 {
-    collocate_buffers_();
-    mpi_manager::communicate(local_grid_spikes_, global_grid_spikes_, displacements_, send_buffer_size_, recv_buffer_size_);
+    if ( targets_ != NULL ) {
+        collocate_sections_();
+        mpi_manager::communicate_Alltoallv(local_grid_spikes_, send_counts_, global_grid_spikes_, displacements_, &volume_);
+        return;
+    }
+    if ( !collocated_ )
+        collocate_buffers_();
+    collocated_ = false;
+    mpi_manager::communicate(local_grid_spikes_, global_grid_spikes_, displacements_, send_buffer_size_, recv_buffer_size_, &volume_, predictive_ ? &sizing_ : NULL);
+}
+
+void
+eventdelivermanager::use_target_table( const target_table& targets )
+{
+    targets_ = &targets;
+}
+
+void
+eventdelivermanager::use_buffer_sizing( const buffer_sizing& sizing )
+{
+    sizing_ = sizing;
+    sizing_.min_size = send_buffer_size_;
+    predictive_ = true;
+}
+
+void
+eventdelivermanager::use_sorted_delivery()
+{
+    sorted_ = true;
 }
 
 void
@@ -115,10 +210,17 @@ eventdelivermanager::deliver_events( thread thrd, long t )
         index nid = global_grid_spikes_[ pos_pid ];
         if ( nid != static_cast< index >( comm_marker_ ) )
         {
+          if ( sorted_ )
+          {
+            delivery_[ thrd ].keys.push_back( ( static_cast< uint64_t >( nid ) << 32 ) | lag );
+          }
+          else
+          {
           // tell all local nodes about spikes on remote machines.
           se.set_stamp( prepared_timestamps[ lag ] );
           se.set_sender_gid( nid );
           cn_.send( thrd, nid, se );
+          }
         }
         else
         {
@@ -128,9 +230,61 @@ eventdelivermanager::deliver_events( thread thrd, long t )
       }
       pos[ pid ] = pos_pid;
     }
+    if ( sorted_ )
+      deliver_sorted_( thrd, prepared_timestamps );
     // skipped the secondary events
 }
 
+/*
+ * stable LSD radix sort of the spikes by source gid (11 bit digits, as
+ * many as the largest gid needs): the spikes of a source keep their
+ * order, the connections are visited in gid order with the connections of
+ * the source prefetch_distance spikes ahead already on their way.
+ */
+void
+eventdelivermanager::deliver_sorted_( thread thrd, const std::vector< Time >& prepared_timestamps )
+{
+    enum { radix_bits = 11, nbuckets = 1 << radix_bits, prefetch_distance = 8 };
+
+    std::vector< uint64_t >& keys = delivery_[ thrd ].keys;
+    std::vector< uint64_t >& tmp = delivery_[ thrd ].tmp;
+    const size_t n = keys.size();
+
+    uint64_t max_key = 0;
+    for ( size_t k = 0; k < n; ++k )
+      max_key = std::max( max_key, keys[ k ] );
+    tmp.resize( n );
+    std::vector< size_t > count( nbuckets );
+    for ( int shift = 32; shift < 64 && ( max_key >> shift ) != 0; shift += radix_bits )
+    {
+      std::fill( count.begin(), count.end(), 0 );
+      for ( size_t k = 0; k < n; ++k )
+        count[ ( keys[ k ] >> shift ) & ( nbuckets - 1 ) ]++;
+      size_t sum = 0;
+      for ( int b = 0; b < nbuckets; ++b )
+      {
+        const size_t c = count[ b ];
+        count[ b ] = sum;
+        sum += c;
+      }
+      for ( size_t k = 0; k < n; ++k )
+        tmp[ count[ ( keys[ k ] >> shift ) & ( nbuckets - 1 ) ]++ ] = keys[ k ];
+      keys.swap( tmp );
+    }
+
+    spikeevent se;
+    for ( size_t k = 0; k < n; ++k )
+    {
+      if ( k + prefetch_distance < n )
+        cn_.prefetch( thrd, keys[ k + prefetch_distance ] >> 32 );
+      const index nid = keys[ k ] >> 32;
+      se.set_stamp( prepared_timestamps[ keys[ k ] & 0xffffffffu ] );
+      se.set_sender_gid( nid );
+      cn_.send( thrd, nid, se );
+    }
+    keys.clear();
+}
+
 
 void
 eventdelivermanager::configure_spike_buffers()
@@ -138,12 +292,7 @@ eventdelivermanager::configure_spike_buffers()
   assert( min_delay_ != 0 );
 
   spike_register_.clear();
-  // the following line does not compile with gcc <= 3.3.5
-  spike_register_.resize( num_threads_,
-    std::vector< std::vector< uint_t > >( min_delay_ ) );
-  for ( size_t j = 0; j < spike_register_.size(); ++j )
-    for ( size_t k = 0; k < spike_register_[ j ].size(); ++k )
-      spike_register_[ j ][ k ].clear();
+  spike_register_.resize( num_threads_, spike_register( min_delay_ ) );
 
   // send_buffer must be >= 2 as the 'overflow' signal takes up 2 spaces
   // plus the fiunal marker and the done flag for iterations
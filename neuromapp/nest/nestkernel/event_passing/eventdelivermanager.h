@@ -8,22 +8,92 @@
 #ifndef EVENTDELIVERYMANAGER_H_
 #define EVENTDELIVERYMANAGER_H_
 
+#include <cstring>
+#include <algorithm>
+#include <stdint.h>
+
 #include "nest/nestkernel/event_passing/mpi_manager.h"
+#include "nest/nestkernel/event_passing/target_table.h"
 
 #include "nest/nestkernel/environment/connectionmanager.h"
 
 namespace nest
 {
+    /**
+     * Gids of the neurons of one thread that spiked, one segment of
+     * capacity_ entries per slice (lag) of the min_delay interval in one
+     * flat buffer, and the number of gids of every segment. A full segment
+     * doubles the capacity of all of them. Only the thread writes to its
+     * register: the counts are padded to a cache line of their own.
+     */
+    class spike_register {
+    private:
+        enum { padding = 64 / sizeof( uint_t ) };
+
+        std::vector< uint_t > gids_;
+        std::vector< uint_t > counts_;
+        size_t min_delay_;
+        size_t capacity_;
+
+        void grow_()
+        {
+            std::vector< uint_t > gids( 2 * gids_.size() );
+            for ( size_t lag = 0; lag < min_delay_; ++lag )
+                std::memcpy( &gids[ 2 * lag * capacity_ ], &gids_[ lag * capacity_ ], counts_[ lag ] * sizeof( uint_t ) );
+            gids_.swap( gids );
+            capacity_ *= 2;
+        }
+
+    public:
+        spike_register( size_t min_delay = 1, size_t capacity = 64 ):
+            gids_( min_delay * capacity ), counts_( min_delay + padding, 0 ),
+            min_delay_( min_delay ), capacity_( capacity ) {}
+
+        inline void push_back( long lag, uint_t gid )
+        {
+            if ( counts_[ lag ] == capacity_ )
+                grow_();
+            gids_[ lag * capacity_ + counts_[ lag ]++ ] = gid;
+        }
+
+        /** number of gids of all the slices */
+        inline size_t size() const
+        {
+            size_t n = 0;
+            for ( size_t lag = 0; lag < min_delay_; ++lag )
+                n += counts_[ lag ];
+            return n;
+        }
+        inline size_t size( long lag ) const { return counts_[ lag ]; }
+        inline const uint_t* begin( long lag ) const { return &gids_[ lag * capacity_ ]; }
+
+        void clear()
+        {
+            std::fill( counts_.begin(), counts_.begin() + min_delay_, 0 );
+        }
+
+        /**
+         * copies the slices to pos, each followed by marker, returns the
+         * end of the copy (size() + min_delay entries)
+         */
+        uint_t* collocate( uint_t* pos, uint_t marker ) const
+        {
+            for ( size_t lag = 0; lag < min_delay_; ++lag )
+            {
+                std::memcpy( pos, &gids_[ lag * capacity_ ], counts_[ lag ] * sizeof( uint_t ) );
+                pos += counts_[ lag ];
+                *pos++ = marker;
+            }
+            return pos;
+        }
+    };
+
     class eventdelivermanager {
     private:
         /**
-         * Register for gids of neurons that spiked. This is a 3-dim
-         * structure.
-         * - First dim: Each thread has its own vector to write to.
-         * - Second dim: A vector for each slice of the min_delay interval
-         * - Third dim: The gids.
+         * Register for gids of neurons that spiked, one per thread.
          */
-        std::vector< std::vector< std::vector< uint_t > > > spike_register_;
+        std::vector< spike_register > spike_register_;
 
          /**
          * Buffer containing the gids of local neurons that spiked in the
@@ -61,20 +131,98 @@ namespace nest
           int num_processes_;
           connectionmanager& cn_;
 
+          /**
+           * Target ranks of the local sources, NULL to send every spike to
+           * every process (Allgather).
+           */
+          const target_table* targets_;
+
+          /**
+           * Size of the section of local_grid_spikes_ sent to every process
+           * (Alltoallv).
+           */
+          std::vector< int > send_counts_;
+
+          comm_volume volume_;
+
+          /**
+           * Size of the Allgather buffers predicted from the past exchanges,
+           * if predictive_ (else grown to the maximum after an overflow).
+           */
+          buffer_sizing sizing_;
+          bool predictive_;
+
+          /**
+           * Start of the section of every thread in local_grid_spikes_, set
+           * by collocate_events.
+           */
+          std::vector< size_t > sections_;
+          bool collocated_;
+
+          /**
+           * Received spikes of every thread as ( source gid << 32 | lag ),
+           * sorted by source before the delivery if sorted_. Padded: every
+           * thread grows its own buffers.
+           */
+          struct delivery_buffer
+          {
+              std::vector< uint64_t > keys;
+              std::vector< uint64_t > tmp;
+              char padding[ 64 ];
+          };
+          std::vector< delivery_buffer > delivery_;
+          bool sorted_;
+
+          void deliver_sorted_( thread thrd, const std::vector< Time >& prepared_timestamps );
+
+          void size_buffers_();
           void collocate_buffers_();
+          void collocate_sections_();
 	  
 	  void configure_spike_buffers();
     public:
           eventdelivermanager(connectionmanager& cn_, const unsigned int num_ranks, const unsigned int num_threads, const unsigned int min_delay);
 
+        /**
+         * Copies the spikes of thrd into the send buffer. Called by all the
+         * threads of the parallel region (synchronizes them) before
+         * gather_events, else gather_events copies the spikes of all the
+         * threads.
+         */
+        void collocate_events( thread thrd );
+
         void gather_events();
         void deliver_events( thread thrd, long t );
 
+        /**
+         * Sends the spikes only to the ranks of their targets from now on.
+         * The table must outlive the manager.
+         */
+        void use_target_table( const target_table& targets );
+
+        /**
+         * Sizes the Allgather buffers with sizing from now on, to avoid the
+         * repeated exchange of an overflow.
+         */
+        void use_buffer_sizing( const buffer_sizing& sizing );
+
+        /**
+         * Delivers the spikes of every exchange in increasing source gid
+         * order from now on (radix sort, prefetch of the next connections)
+         * instead of the order of the receive buffer.
+         */
+        void use_sorted_delivery();
+
+        /**
+         * Entries sent and received by the process since the construction.
+         */
+        const comm_volume& get_comm_volume() const { return volume_; }
+
         inline void
         send_remote( thread t, spikeevent& e, const long lag )
         {
             // Put the spike in a buffer for the remote machines
-            spike_register_[ t ][ lag ].push_back( e.get_sender_gid() );
+            spike_register_[ t ].push_back( lag, e.get_sender_gid() );
         }
 
 
@@ -4,14 +4,42 @@
  *  Created on: Jul 6, 2016
  *      Author: schumann
  */
+#include <cmath>
+#include <algorithm>
+
 #include "nest/nestkernel/event_passing/mpi_manager.h"
 
+int
+nest::buffer_sizing::next_size( int needed, int size )
+{
+    level = std::max( static_cast< double >( needed ), decay * level );
+    const double wanted = growth * level;
+    if ( size < wanted )
+    {
+      while ( size < wanted )
+        size = std::max( size + 1, static_cast< int >( std::ceil( growth * size ) ) );
+    }
+    else if ( shrink && size > growth * wanted )
+    {
+      size = std::max( static_cast< int >( std::ceil( size / growth ) ),
+        static_cast< int >( std::ceil( wanted ) ) );
+    }
+    return std::max( std::max( size, needed ), min_size );
+}
+
+/*
+ * with sizing, the last entry of a send buffer that fits holds the number
+ * of entries the process needs: every process knows the maximum after the
+ * exchange (overflow or not) and sets the same size for the next one.
+ */
 void
 nest::mpi_manager::communicate_Allgather( std::vector< uint_t >& send_buffer,
   std::vector< uint_t >& recv_buffer,
   std::vector< int >& displacements,
   int& send_buffer_size,
-  int& recv_buffer_size)
+  int& recv_buffer_size,
+  comm_volume* volume,
+  buffer_sizing* sizing)
 {
     int num_processes;
 
@@ -48,6 +76,7 @@ nest::mpi_manager::communicate_Allgather( std::vector< uint_t >& send_buffer,
     // check for overflow condition
     int disp = 0;
     uint_t max_recv_count = send_buffer_size;
+    uint_t max_needed = 0;
     bool overflow = false;
     for ( int pid = 0; pid < num_processes; ++pid )
     {
@@ -61,10 +90,22 @@ nest::mpi_manager::communicate_Allgather( std::vector< uint_t >& send_buffer,
       {
         max_recv_count = recv_counts[ pid ];
       }
+      max_needed = std::max( max_needed, static_cast< uint_t >( recv_counts[ pid ] ) );
+    }
+    else if ( sizing != NULL )
+    {
+      max_needed = std::max( max_needed, recv_buffer[ block_disp + send_buffer_size - 1 ] );
     }
     disp += recv_counts[ pid ];
     }
 
+    if ( volume != NULL )
+    {
+    volume->sent += send_buffer_size * ( num_processes - 1 );
+    volume->received += send_buffer_size * ( num_processes - 1 );
+    volume->exchanges++;
+    }
+
     // do Allgatherv if necessary
     if ( overflow )
     {
@@ -77,9 +118,23 @@ nest::mpi_manager::communicate_Allgather( std::vector< uint_t >& send_buffer,
       &displacements[ 0 ],
       MPI_UNSIGNED,
       comm );
+    if ( volume != NULL )
+    {
+      int rank;
+      MPI_Comm_rank( comm, &rank );
+      volume->sent += send_buffer.size() * ( num_processes - 1 );
+      volume->received += disp - recv_counts[ rank ];
+      volume->overflows++;
+    }
     send_buffer_size = max_recv_count;
     recv_buffer_size = send_buffer_size * num_processes;
     }
+
+    if ( sizing != NULL )
+    {
+    send_buffer_size = sizing->next_size( max_needed, send_buffer_size );
+    recv_buffer_size = send_buffer_size * num_processes;
+    }
 }
 
 void
@@ -87,7 +142,9 @@ nest::mpi_manager::communicate( std::vector< uint_t >& send_buffer,
   std::vector< uint_t >& recv_buffer,
   std::vector< int >& displacements,
   int& send_buffer_size,
-  int& recv_buffer_size)
+  int& recv_buffer_size,
+  comm_volume* volume,
+  buffer_sizing* sizing)
 {
     int num_processes;
     MPI_Comm_size(MPI_COMM_WORLD, &num_processes);
@@ -101,8 +158,66 @@ nest::mpi_manager::communicate( std::vector< uint_t >& send_buffer,
             recv_buffer.resize( recv_buffer_size );
         }
         recv_buffer.swap( send_buffer );
+        if ( volume != NULL )
+            volume->exchanges++;
     }
     else {
-        communicate_Allgather( send_buffer, recv_buffer, displacements, send_buffer_size, recv_buffer_size );
+        communicate_Allgather( send_buffer, recv_buffer, displacements, send_buffer_size, recv_buffer_size, volume, sizing );
+    }
+}
+
+/*
+ * every process sends the section send_counts[ pid ] of send_buffer to
+ * process pid only (sections in increasing pid order). The sizes are
+ * exchanged first, displacements receives the start of the section of
+ * every process in recv_buffer.
+ */
+void
+nest::mpi_manager::communicate_Alltoallv( std::vector< uint_t >& send_buffer,
+  std::vector< int >& send_counts,
+  std::vector< uint_t >& recv_buffer,
+  std::vector< int >& displacements,
+  comm_volume* volume)
+{
+    int num_processes, rank;
+    MPI_Comm comm = MPI_COMM_WORLD;
+    MPI_Comm_size(comm, &num_processes);
+    MPI_Comm_rank(comm, &rank);
+
+    std::vector< int > recv_counts( num_processes, 0 );
+    MPI_Alltoall( &send_counts[ 0 ], 1, MPI_INT, &recv_counts[ 0 ], 1, MPI_INT, comm );
+
+    std::vector< int > send_displacements( num_processes, 0 );
+    displacements.resize( num_processes, 0 );
+    int send_disp = 0;
+    int disp = 0;
+    for ( int pid = 0; pid < num_processes; ++pid )
+    {
+      send_displacements[ pid ] = send_disp;
+      send_disp += send_counts[ pid ];
+      displacements[ pid ] = disp;
+      disp += recv_counts[ pid ];
+    }
+
+    // &buffer[ 0 ] must be valid
+    if ( send_buffer.empty() )
+      send_buffer.resize( 1, 0 );
+    recv_buffer.resize( disp > 0 ? disp : 1, 0 );
+    MPI_Alltoallv( &send_buffer[ 0 ],
+      &send_counts[ 0 ],
+      &send_displacements[ 0 ],
+      MPI_UNSIGNED,
+      &recv_buffer[ 0 ],
+      &recv_counts[ 0 ],
+      &displacements[ 0 ],
+      MPI_UNSIGNED,
+      comm );
+
+    if ( volume != NULL )
+    {
+      // the counts, then the sections of the other processes
+      volume->sent += ( num_processes - 1 ) + send_disp - send_counts[ rank ];
+      volume->received += ( num_processes - 1 ) + disp - recv_counts[ rank ];
+      volume->exchanges++;
     }
 }
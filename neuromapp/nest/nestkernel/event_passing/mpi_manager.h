@@ -22,6 +22,41 @@ typedef unsigned int uint_t;
 
 namespace nest
 {
+    /**
+     * entries (uint_t) sent to and received from the other processes
+     */
+    struct comm_volume
+    {
+        comm_volume(): sent(0), received(0), exchanges(0), overflows(0) {}
+        unsigned long sent;
+        unsigned long received;
+        unsigned long exchanges;
+        /// exchanges repeated with MPI_Allgatherv (send buffer too small)
+        unsigned long overflows;
+    };
+
+    /**
+     * predictive size of the Allgather send buffer: level is an
+     * exponentially weighted maximum of the entries needed by the processes
+     * per exchange. The buffer grows geometrically to keep growth times the
+     * level available before it overflows, and shrinks (optionally) one
+     * step at a time once it is larger than growth^2 times the level.
+     */
+    struct buffer_sizing
+    {
+        buffer_sizing( double decay_ = 0.9, double growth_ = 1.5, bool shrink_ = false ):
+          decay( decay_ ), growth( growth_ ), shrink( shrink_ ), level( 0. ), min_size( 4 ) {}
+        double decay;
+        double growth;
+        bool shrink;
+        double level;
+        /// never shrink below
+        int min_size;
+
+        /** size of the next exchange, needed the maximum over all processes */
+        int next_size( int needed, int size );
+    };
+
     namespace mpi_manager
     {
         void
@@ -29,14 +64,25 @@ namespace nest
           std::vector< uint_t >& recv_buffer,
           std::vector< int >& displacements,
           int& send_buffer_size,
-          int& recv_buffer_size);
+          int& recv_buffer_size,
+          comm_volume* volume = NULL,
+          buffer_sizing* sizing = NULL);
 
         void
         communicate( std::vector< uint_t >& send_buffer,
           std::vector< uint_t >& recv_buffer,
           std::vector< int >& displacements,
           int& send_buffer_size,
-          int& recv_buffer_size);
+          int& recv_buffer_size,
+          comm_volume* volume = NULL,
+          buffer_sizing* sizing = NULL);
+
+        void
+        communicate_Alltoallv( std::vector< uint_t >& send_buffer,
+          std::vector< int >& send_counts,
+          std::vector< uint_t >& recv_buffer,
+          std::vector< int >& displacements,
+          comm_volume* volume = NULL);
     };
 };
 
@@ -0,0 +1,78 @@
+/*
+ * target_table.cpp
+ *
+ *  Created on: Jul 6, 2016
+ *      Author: schumann
+ */
+
+#include "nest/nestkernel/event_passing/target_table.h"
+
+void
+nest::target_table::build(const environment::continousdistribution& neuro_dist,
+                          const environment::presyn_maker& presyns,
+                          MPI_Comm comm)
+{
+    int rank, num_processes;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &num_processes);
+
+    const size_t nlocal = neuro_dist.getlocalcells();
+    first_gid_ = nlocal > 0 ? neuro_dist.local2global(0) : 0;
+
+    // remote sources of the local targets, sorted: contiguous per owner
+    std::vector< int > inputs;
+    presyns.input_gids(inputs);
+    std::vector< int > requests;
+    std::vector< int > send_counts( num_processes, 0 );
+    for ( size_t i = 0; i < inputs.size(); ++i ) {
+        const environment::presyn* ps = presyns.find_input(inputs[ i ]);
+        if ( ps == NULL || ps->size() == 0 )
+            continue;
+        requests.push_back(inputs[ i ]);
+        send_counts[ environment::continousdistribution::owner(
+            inputs[ i ], num_processes, neuro_dist.getglobalcells()) ]++;
+    }
+
+    std::vector< int > recv_counts( num_processes, 0 );
+    MPI_Alltoall(&send_counts[ 0 ], 1, MPI_INT, &recv_counts[ 0 ], 1, MPI_INT, comm);
+
+    std::vector< int > send_displacements( num_processes, 0 );
+    std::vector< int > recv_displacements( num_processes + 1, 0 );
+    for ( int pid = 1; pid < num_processes; ++pid )
+        send_displacements[ pid ] = send_displacements[ pid - 1 ] + send_counts[ pid - 1 ];
+    for ( int pid = 0; pid < num_processes; ++pid )
+        recv_displacements[ pid + 1 ] = recv_displacements[ pid ] + recv_counts[ pid ];
+
+    // the local gids needed by every rank
+    std::vector< int > needed( recv_displacements[ num_processes ] + 1 );
+    requests.push_back(0); // &requests[ 0 ] valid when nothing is requested
+    MPI_Alltoallv(&requests[ 0 ], &send_counts[ 0 ], &send_displacements[ 0 ], MPI_INT,
+                  &needed[ 0 ], &recv_counts[ 0 ], &recv_displacements[ 0 ], MPI_INT, comm);
+
+    // count, then fill in increasing rank order
+    offsets_.assign(nlocal + 1, 0);
+    std::vector< char > self( nlocal, 0 );
+    for ( size_t lid = 0; lid < nlocal; ++lid ) {
+        const environment::presyn* ps = presyns.find_output(first_gid_ + lid);
+        self[ lid ] = ps != NULL && ps->size() > 0;
+        offsets_[ lid + 1 ] += self[ lid ];
+    }
+    for ( int k = 0; k < recv_displacements[ num_processes ]; ++k )
+        offsets_[ neuro_dist.global2local(needed[ k ]) + 1 ]++;
+    for ( size_t lid = 0; lid < nlocal; ++lid )
+        offsets_[ lid + 1 ] += offsets_[ lid ];
+
+    ranks_.resize(offsets_[ nlocal ]);
+    std::vector< int > pos( offsets_.begin(), offsets_.end() - 1 );
+    for ( int pid = 0; pid < num_processes; ++pid ) {
+        if ( pid == rank ) {
+            for ( size_t lid = 0; lid < nlocal; ++lid )
+                if ( self[ lid ] )
+                    ranks_[ pos[ lid ]++ ] = rank;
+        }
+        else {
+            for ( int k = recv_displacements[ pid ]; k < recv_displacements[ pid + 1 ]; ++k )
+                ranks_[ pos[ neuro_dist.global2local(needed[ k ]) ]++ ] = pid;
+        }
+    }
+}
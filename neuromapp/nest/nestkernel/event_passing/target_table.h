@@ -0,0 +1,62 @@
+/*
+ * target_table.h
+ *
+ *  Created on: Jul 6, 2016
+ *      Author: schumann
+ */
+
+#ifndef TARGET_TABLE_H_
+#define TARGET_TABLE_H_
+
+#include <vector>
+#include <cassert>
+
+#include <mpi.h>
+
+#include "coreneuron_1.0/event_passing/environment/neurondistribution.h"
+#include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
+
+namespace nest
+{
+    /**
+     * \class target_table
+     * \brief for every local source gid, the ranks hosting at least one of
+     * its targets (NEST 5g target tables). The ranks only know the remote
+     * sources of their own targets (input presyns): build() sends these gids
+     * once to the ranks owning them (MPI_Alltoallv). The rank itself is in
+     * the list of a source with local targets (output presyns).
+     */
+    class target_table {
+    private:
+        /// first gid of the rank
+        size_t first_gid_;
+        /// ranks of the local source lid: ranks_[ offsets_[ lid ] ] to ranks_[ offsets_[ lid + 1 ] - 1 ]
+        std::vector< int > offsets_;
+        std::vector< int > ranks_;
+
+    public:
+        target_table(): first_gid_(0), offsets_(1, 0) {}
+
+        void build(const environment::continousdistribution& neuro_dist,
+                   const environment::presyn_maker& presyns,
+                   MPI_Comm comm = MPI_COMM_WORLD);
+
+        /** first target rank of the local source gid */
+        inline const int* begin( size_t gid ) const
+        {
+            assert(gid >= first_gid_ && gid - first_gid_ + 1 < offsets_.size());
+            return ranks_.empty() ? NULL : &ranks_[ 0 ] + offsets_[ gid - first_gid_ ];
+        }
+
+        /** past the last target rank of the local source gid */
+        inline const int* end( size_t gid ) const
+        {
+            return ranks_.empty() ? NULL : &ranks_[ 0 ] + offsets_[ gid - first_gid_ + 1 ];
+        }
+
+        /** number of (source, target rank) pairs */
+        inline size_t size() const { return ranks_.size(); }
+    };
+};
+
+#endif /* TARGET_TABLE_H_ */
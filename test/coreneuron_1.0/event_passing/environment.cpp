@@ -30,10 +30,14 @@
 #include <stdlib.h>
 #include <time.h>
 #include <ctime>
+#include <cmath>
+#include <algorithm>
 
 #include "coreneuron_1.0/event_passing/environment/generator.h"
 #include "coreneuron_1.0/event_passing/environment/event_generators.hpp"
 #include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
+#include "coreneuron_1.0/event_passing/environment/presyn_table.h"
+#include "coreneuron_1.0/event_passing/environment/stream_generator.h"
 
 /**
  * Test the constructor of presyn_maker class
@@ -182,6 +186,25 @@ BOOST_AUTO_TEST_CASE(presyns_check_neuron_dist){
     BOOST_CHECK(diff == 0 || diff == 1);
 }
 
+/**
+ * Test that continousdistribution::owner gives the group whose
+ * distribution holds the cell, with and without remainder
+ */
+BOOST_AUTO_TEST_CASE(continousdistribution_owner){
+    const int sizes[3] = {3, 40, 43};
+    for (int s = 0; s < 3; s++) {
+        const int ncells = sizes[s];
+        for (int ngroups = 1; ngroups <= 6; ngroups++) {
+            for (int group = 0; group < ngroups; group++) {
+                environment::continousdistribution neuro_dist(ngroups, group, ncells);
+                for (int cell = 0; cell < ncells; cell++)
+                    BOOST_CHECK_EQUAL(environment::continousdistribution::owner(cell, ngroups, ncells) == group,
+                                      neuro_dist.isLocal(cell));
+            }
+        }
+    }
+}
+
 /**
  * Test generation of events for kai_generator
  */
@@ -381,3 +404,90 @@ BOOST_AUTO_TEST_CASE(generator_compare_top_lte){
     BOOST_CHECK(greater_than_min);
     BOOST_CHECK(less_than_max);
 }
+
+/**
+ * Test that presyn_table finds the same presyns as the map it is built
+ * from, for dense keys (direct index) and sparse keys (hash table),
+ * and after a copy
+ */
+BOOST_AUTO_TEST_CASE(presyn_table_test){
+    boost::mt19937 rng(time(NULL));
+    boost::random::uniform_int_distribution<> uniform(0, 20);
+
+    //stride 1 is dense, stride 1000 is sparse
+    for(int stride = 1; stride <= 1000; stride *= 1000){
+        std::map<int, std::vector<int> > m;
+        for(int i = 0; i < 500; ++i){
+            std::vector<int>& v = m[7 + i * stride];
+            const int n = uniform(rng);
+            for(int j = 0; j < n; ++j)
+                v.push_back(uniform(rng));
+        }
+
+        environment::presyn_table table;
+        table.build(m);
+        environment::presyn_table copy(table);
+        BOOST_CHECK_EQUAL(table.size(), m.size());
+
+        std::vector<int> keys;
+        table.keys(keys);
+        BOOST_REQUIRE_EQUAL(keys.size(), m.size());
+        std::map<int, std::vector<int> >::const_iterator k = m.begin();
+        for(int i = 0; i < keys.size(); ++i, ++k)
+            BOOST_CHECK_EQUAL(keys[i], k->first);
+
+        for(int key = 0; key < 500 * stride + 10; ++key){
+            std::map<int, std::vector<int> >::const_iterator it = m.find(key);
+            const environment::presyn* ps = table.find(key);
+            const environment::presyn* pc = copy.find(key);
+            if(it == m.end()){
+                BOOST_CHECK(ps == NULL);
+                BOOST_CHECK(pc == NULL);
+                continue;
+            }
+            BOOST_REQUIRE(ps != NULL);
+            BOOST_REQUIRE(pc != NULL);
+            BOOST_CHECK_EQUAL_COLLECTIONS(ps->begin(), ps->end(),
+                                          it->second.begin(), it->second.end());
+            BOOST_CHECK_EQUAL_COLLECTIONS(pc->begin(), pc->end(),
+                                          it->second.begin(), it->second.end());
+        }
+    }
+}
+
+/**
+ * Test that stream_generator pops events in time order, before simtime,
+ * with the expected mean count, and that the spike trains do not depend
+ * on the number of cell groups
+ */
+BOOST_AUTO_TEST_CASE(stream_generator_test){
+    int ncells = 200;
+    int simtime = 1000;
+    double rate = 0.01;
+    environment::continousdistribution neuro_dist(1, 0, ncells);
+
+    std::vector<environment::gen_event> all[2];
+    int ngroups[2] = {1, 4};
+    for(int n = 0; n < 2; ++n){
+        environment::stream_generator generator(ngroups[n], simtime, rate, 7, neuro_dist);
+        for(int i = 0; i < ngroups[n]; ++i){
+            double previous = 0.;
+            while(!generator.empty(i)){
+                BOOST_REQUIRE(generator.compare_top_lte(i, simtime));
+                environment::gen_event g = generator.pop(i);
+                BOOST_CHECK(g.second >= previous);
+                BOOST_CHECK(g.second < simtime);
+                BOOST_CHECK_EQUAL(g.first % ngroups[n], i);
+                previous = g.second;
+                all[n].push_back(g);
+            }
+            BOOST_CHECK(!generator.compare_top_lte(i, simtime));
+        }
+        std::sort(all[n].begin(), all[n].end());
+    }
+    BOOST_CHECK(all[0] == all[1]);
+
+    //2000 spikes expected, Poisson std ~45
+    const double expected = rate * simtime * ncells;
+    BOOST_CHECK(std::abs(all[0].size() - expected) < 0.1 * expected);
+}
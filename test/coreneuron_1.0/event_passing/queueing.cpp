@@ -26,16 +26,19 @@
 #define IMPL T::impl
 
 #include <boost/test/unit_test.hpp>
+#include <set>
 #include <boost/filesystem.hpp>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <cstdio>
 
 #include "coreneuron_1.0/event_passing/queueing/queue.h"
 #include "coreneuron_1.0/event_passing/queueing/pool.h"
 #include "coreneuron_1.0/event_passing/queueing/thread.h"
+#include "coreneuron_1.0/event_passing/queueing/telemetry.h"
 #include "coreneuron_1.0/event_passing/environment/generator.h"
 #include "coreneuron_1.0/event_passing/environment/event_generators.hpp"
 #include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
@@ -166,6 +169,107 @@ BOOST_AUTO_TEST_CASE(thread_deliver){
     BOOST_CHECK(nt.pq_size() == 0);
 }
 
+/**
+ * Unit test for queue::drain_until
+ *
+ * checks that it pops the same events as the atomic_dq loop, in time
+ * order, for a few due events (pops) and many (one pass)
+ */
+BOOST_AUTO_TEST_CASE(queue_drain_until){
+    srand(3);
+    queueing::queue bulk, reference;
+    for(int i = 0; i < 1000; ++i){
+        double t = rand() % 500;
+        bulk.insert(t, i);
+        reference.insert(t, i);
+    }
+    std::vector<queueing::event> out;
+    const double tils[] = {-1., 2., 3., 400., 401., 1000.};
+    for(int k = 0; k < 6; ++k){
+        out.clear();
+        size_t n = bulk.drain_until(tils[k], out);
+        BOOST_REQUIRE_EQUAL(n, out.size());
+        queueing::event e;
+        for(size_t i = 0; i < n; ++i){
+            BOOST_REQUIRE(reference.atomic_dq(tils[k], e));
+            BOOST_CHECK_EQUAL(out[i].t_, e.t_);
+        }
+        BOOST_CHECK(!reference.atomic_dq(tils[k], e));
+        BOOST_CHECK_EQUAL(bulk.size(), reference.size());
+    }
+    BOOST_CHECK_EQUAL(bulk.size(), 0);
+}
+
+/**
+ * Unit test for nrn_thread_data::deliver_all
+ *
+ * same deliveries as the deliver loop of thread_deliver, and the same trace
+ */
+BOOST_AUTO_TEST_CASE(thread_deliver_all){
+    queueing::nrn_thread_data nt;
+    queue::trace trace;
+    nt.record_trace(&trace);
+
+    nt.self_send(0,4.0);
+    nt.self_send(0,1.0);
+    nt.self_send(0,2.0);
+    nt.self_send(0,5.0);
+
+    nt.increment_time();
+    nt.increment_time();
+    BOOST_CHECK_EQUAL(nt.deliver_all(), 2);
+    BOOST_CHECK_EQUAL(nt.delivered_, 2);
+    BOOST_CHECK_EQUAL(nt.pq_size(), 2);
+    BOOST_CHECK_EQUAL(nt.deliver_all(), 0);
+
+    nt.increment_time();
+    nt.increment_time();
+    nt.increment_time();
+    BOOST_CHECK_EQUAL(nt.deliver_all(), 2);
+    BOOST_CHECK_EQUAL(nt.delivered_, 4);
+    BOOST_CHECK_EQUAL(nt.pq_size(), 0);
+
+    //4 inserts, then 3 + 1 atomic_dq(2.) and 3 atomic_dq(5.)
+    BOOST_CHECK_EQUAL(trace.noperations(), 11);
+    BOOST_CHECK_EQUAL(trace.size(), 6);
+}
+
+/**
+ * Unit test for the trace of the queue operations
+ *
+ * checks the inserts are recorded with their time, and the atomic_dq of a
+ * delivery loop are collapsed into one record
+ */
+BOOST_AUTO_TEST_CASE(thread_record_trace){
+    queueing::nrn_thread_data nt;
+    queue::trace trace;
+    nt.record_trace(&trace);
+
+    nt.self_send(0,1.0);
+    nt.self_send(0,2.0);
+    nt.self_send(0,5.0);
+    nt.increment_time();
+    nt.increment_time();
+    while(nt.deliver())
+        ;
+    BOOST_CHECK(nt.delivered_ == 2);
+
+    //3 inserts + 3 atomic_dq(2.) (two succeed, one fails)
+    BOOST_CHECK_EQUAL(trace.size(), 4);
+    BOOST_CHECK_EQUAL(trace.noperations(), 6);
+    queue::trace::const_iterator it = trace.begin();
+    BOOST_CHECK(it->op_ == queue::trace_insert && it->t_ == 1.0);
+    it += 2;
+    BOOST_CHECK(it->op_ == queue::trace_insert && it->t_ == 5.0);
+    ++it;
+    BOOST_CHECK(it->op_ == queue::trace_dq && it->t_ == 2.0);
+    BOOST_CHECK_EQUAL(static_cast<int>(it->repeat_), 3);
+
+    nt.record_trace(NULL);
+    nt.self_send(0,6.0);
+    BOOST_CHECK_EQUAL(trace.size(), 4);
+}
+
 /**
  * Unit test for net_receive function
  *
@@ -205,6 +309,53 @@ BOOST_AUTO_TEST_CASE(pool_constructor){
     BOOST_CHECK(pl.get_ngroups() == ngroups);
 }
 
+/**
+ * Tests that the cell groups own distinct NrnThreads with cloned_data
+ * (default) and share the storage one with shared_data
+ */
+BOOST_AUTO_TEST_CASE(pool_nrnthread_source){
+    int nprocs = 4;
+    int ngroups = 4;
+    int mindelay = 5;
+    spike::spike_interface spike(nprocs);
+
+    queueing::nrn_thread_data reference;
+    {
+        queueing::pool pl(false, ngroups, mindelay, 0, spike);
+        std::set<const NrnThread*> nts;
+        for(int i = 0; i < ngroups; ++i)
+            nts.insert(pl.nrnthread(i));
+        BOOST_CHECK_EQUAL(nts.size(), ngroups);
+        BOOST_CHECK(nts.count(reference.nrnthread()) == 0);
+    }
+    queueing::pool pl(false, ngroups, mindelay, 0, spike, queueing::shared_data);
+    for(int i = 0; i < ngroups; ++i)
+        BOOST_CHECK(pl.nrnthread(i) == reference.nrnthread());
+}
+
+/**
+ * Tests that a copy of a thread data owning a cloned NrnThread gets its own
+ * clone, and that a copy of a shared one shares it
+ */
+BOOST_AUTO_TEST_CASE(nrn_thread_data_copy){
+    queueing::nrn_thread_data shared;
+    queueing::nrn_thread_data owner;
+    owner.clone_nrnthread();
+    BOOST_CHECK(owner.nrnthread() != shared.nrnthread());
+
+    queueing::nrn_thread_data copy(owner);
+    BOOST_CHECK(copy.nrnthread() != owner.nrnthread());
+    BOOST_CHECK(copy.nrnthread() != shared.nrnthread());
+
+    queueing::nrn_thread_data assigned;
+    assigned.clone_nrnthread();
+    assigned = shared;
+    BOOST_CHECK(assigned.nrnthread() == shared.nrnthread());
+    assigned = owner;
+    BOOST_CHECK(assigned.nrnthread() != owner.nrnthread());
+    BOOST_CHECK(assigned.nrnthread() != copy.nrnthread());
+}
+
  /**
   * Tests the constructor for the generator class
   * Specific set of parameters to elicit failure
@@ -322,3 +473,140 @@ BOOST_AUTO_TEST_CASE(pool_send_ite){
     //check that every event went to the spikeout_ buffer
     BOOST_CHECK(spike.spikeout_.size() == sum_events);
 }
+
+/**
+ * Tests that every schedule of fixed_step sends all the events and
+ * records the load of every min delay interval
+ */
+BOOST_AUTO_TEST_CASE(pool_schedule){
+    int ncells = 10;
+    int fanin = 5;
+    int nprocs = 4;
+    int ngroups = 8;
+    int nspikes = 1000;
+    int mindelay = 5;
+    int simtime = 100;
+    int rank = 0;
+
+    queueing::schedule_mode schedules[3] = {queueing::static_schedule,
+        queueing::dynamic_schedule, queueing::task_schedule};
+    for(int s = 0; s < 3; ++s){
+        environment::continousdistribution neuro_dist(nprocs, rank, ncells);
+        environment::presyn_maker presyns(fanin);
+        spike::spike_interface spike(nprocs);
+
+        presyns(rank, &neuro_dist);
+        environment::event_generator generator(ngroups);
+
+        double mean = static_cast<double>(simtime) / static_cast<double>(nspikes);
+        double lambda = 1.0 / static_cast<double>(mean * nprocs);
+
+        environment::generate_events_kai(generator.begin(),
+                        simtime, ngroups, rank, nprocs, lambda, &neuro_dist);
+
+        int sum_events = 0;
+        for(int i = 0; i < ngroups; ++i){
+            sum_events += generator.get_size(i);
+        }
+
+        queueing::pool pl(false, ngroups, mindelay, rank, spike,
+            queueing::cloned_data, schedules[s]);
+        int nintervals = 0;
+        while(pl.get_time() <= simtime){
+            pl.fixed_step(generator, presyns);
+            ++nintervals;
+        }
+
+        BOOST_CHECK_EQUAL(spike.spikeout_.size(), sum_events);
+        BOOST_CHECK_EQUAL(pl.loads().size(), nintervals);
+        for(int i = 0; i < pl.loads().size(); ++i){
+            BOOST_CHECK(pl.loads()[i].max_busy_ >= pl.loads()[i].mean_busy_);
+            BOOST_CHECK(pl.loads()[i].wall_ >= 0.);
+        }
+
+        pl.accumulate_stats();
+        BOOST_CHECK(spike.interval_stats_ <= nintervals);
+        if(spike.interval_stats_ > 0){
+            BOOST_CHECK(spike.imbalance_stats_ >= 1.);
+            BOOST_CHECK(spike.max_imbalance_stats_ >= spike.p99_imbalance_stats_);
+        }
+    }
+}
+
+/**
+ * Unit test for the telemetry of the pool
+ *
+ * one sample per cell group and interval, the delivered events add up to the
+ * counters of the thread datas, the binary file reads back the same series
+ */
+BOOST_AUTO_TEST_CASE(pool_telemetry){
+    int ncells = 10;
+    int fanin = 5;
+    int nprocs = 4;
+    int ngroups = 4;
+    int nspikes = 1000;
+    int mindelay = 5;
+    int simtime = 100;
+    int rank = 0;
+
+    //the counters of adjacent cell groups are at least a cache line apart
+    std::vector<queueing::nrn_thread_data> datas(2);
+    BOOST_CHECK(reinterpret_cast<char*>(&datas[1].ite_received_) -
+        reinterpret_cast<char*>(&datas[0].deliver_time_) >= queueing::cache_line);
+    BOOST_CHECK(reinterpret_cast<char*>(&datas[0].local_received_) -
+        reinterpret_cast<char*>(&datas[0].ite_received_) >= queueing::cache_line);
+
+    environment::continousdistribution neuro_dist(nprocs, rank, ncells);
+    environment::presyn_maker presyns(fanin);
+    spike::spike_interface spike(nprocs);
+    presyns(rank, &neuro_dist);
+    environment::event_generator generator(ngroups);
+    double mean = static_cast<double>(simtime) / static_cast<double>(nspikes);
+    double lambda = 1.0 / static_cast<double>(mean * nprocs);
+    environment::generate_events_kai(generator.begin(),
+                    simtime, ngroups, rank, nprocs, lambda, &neuro_dist);
+
+    queueing::pool pl(false, ngroups, mindelay, rank, spike);
+    BOOST_CHECK(!pl.get_telemetry().enabled());
+    pl.record_telemetry();
+    int nintervals = 0;
+    while(pl.get_time() <= simtime){
+        pl.fixed_step(generator, presyns);
+        ++nintervals;
+    }
+
+    const queueing::telemetry& t = pl.get_telemetry();
+    BOOST_CHECK_EQUAL(t.ngroups(), ngroups);
+    BOOST_CHECK_EQUAL(t.min_delay(), mindelay);
+    BOOST_CHECK_EQUAL(t.nintervals(), nintervals);
+    int delivered = 0;
+    for(int i = 0; i < t.nintervals(); ++i){
+        for(int j = 0; j < ngroups; ++j)
+            delivered += t.sample(i, j).delivered_;
+    }
+    pl.accumulate_stats();
+    BOOST_CHECK_EQUAL(delivered, spike.delivered_stats_);
+    BOOST_CHECK(delivered > 0);
+    queueing::telemetry_stats st = t.stats(queueing::delivered_events);
+    BOOST_CHECK_EQUAL(st.n_, nintervals * ngroups);
+    BOOST_CHECK(st.p50_ <= st.p99_ && st.p99_ <= st.max_);
+    BOOST_CHECK_CLOSE(st.mean_ * st.n_, static_cast<double>(delivered), 1e-6);
+
+    std::string name("telemetry_test.bin");
+    BOOST_CHECK(pl.write_telemetry(name));
+    queueing::telemetry r;
+    BOOST_CHECK(r.read(name));
+    BOOST_CHECK_EQUAL(r.nintervals(), nintervals);
+    for(int i = 0; i < r.nintervals(); ++i){
+        for(int j = 0; j < ngroups; ++j){
+            BOOST_CHECK_EQUAL(r.sample(i, j).queue_depth_, t.sample(i, j).queue_depth_);
+            BOOST_CHECK_EQUAL(r.sample(i, j).inbox_, t.sample(i, j).inbox_);
+            BOOST_CHECK_EQUAL(r.sample(i, j).deliver_us_, t.sample(i, j).deliver_us_);
+        }
+    }
+    std::stringstream summary;
+    r.summarize(summary);
+    BOOST_CHECK(summary.str().find("delivery ns/event") != std::string::npos);
+    std::remove(name.c_str());
+    BOOST_CHECK(!r.read(name));
+}
@@ -31,11 +31,20 @@
 #include <time.h>
 #include <stdlib.h>
 #include <numeric>
+#include <algorithm>
 #include <iostream>
+#include <sstream>
 
 #include "coreneuron_1.0/common/data/helper.h"
 #include "coreneuron_1.0/event_passing/spike/algos.hpp"
 #include "coreneuron_1.0/event_passing/spike/spike_interface.h"
+#include "coreneuron_1.0/event_passing/spike/encoding.h"
+#include "coreneuron_1.0/event_passing/spike/distributed.hpp"
+#include "coreneuron_1.0/event_passing/spike/hierarchical.hpp"
+#include "coreneuron_1.0/event_passing/spike/targeted.hpp"
+#include "coreneuron_1.0/event_passing/spike/adaptive.hpp"
+#include "coreneuron_1.0/event_passing/spike/benchmark.hpp"
+#include "coreneuron_1.0/event_passing/environment/presyn_maker.h"
 #include "utils/error.h"
 namespace bfs = ::boost::filesystem;
 
@@ -88,6 +97,333 @@ BOOST_AUTO_TEST_CASE(displ_test){
     }
 }
 
+/**
+ * tests that the compact codec round trips spikes, with the
+ * 16 bits time offsets (short interval) and the 32 bits ones
+ * (offsets larger than 65535 resolution units)
+ */
+BOOST_AUTO_TEST_CASE(compact_codec_round_trip){
+    spike::compact_codec codec;
+    for(int span = 10; span <= 100000; span *= 100){
+        std::vector<queueing::event> spikes;
+        for(int i = 0; i < 50; ++i){
+            queueing::event e;
+            e.data_ = rand()%100000;
+            e.t_ = 200 + rand()%span;
+            spikes.push_back(e);
+        }
+        std::vector<queueing::event> expected(spikes);
+        std::sort(expected.begin(), expected.end(), spike::gid_less);
+
+        //two segments, as after an allgatherv from two senders
+        std::vector<unsigned char> bytes;
+        codec.encode(spikes, bytes);
+        codec.encode(spikes, bytes);
+        BOOST_CHECK(bytes.size() < 2 * spikes.size() * sizeof(queueing::event));
+
+        spike::compact_reader reader(&bytes[0], &bytes[0] + bytes.size());
+        queueing::event e;
+        for(int n = 0; n < 2; ++n){
+            for(size_t i = 0; i < expected.size(); ++i){
+                BOOST_REQUIRE(reader.next(e));
+                BOOST_CHECK_EQUAL(e.data_, expected[i].data_);
+                BOOST_CHECK_EQUAL(e.t_, expected[i].t_);
+            }
+        }
+        BOOST_CHECK(!reader.next(e));
+    }
+}
+
+/**
+ * tests that every rank decodes the spikes of all the ranks
+ * after a compact_blocking_spike exchange
+ */
+BOOST_AUTO_TEST_CASE(compact_blocking_spike_exchange){
+    int size;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    spike::spike_interface interface(size);
+    //rank r sends r+1 spikes, gid = r*1000+i at time 10+i
+    for(int i = 0; i <= rank; ++i){
+        queueing::event e;
+        e.data_ = rank * 1000 + i;
+        e.t_ = 10 + i;
+        interface.spikeout_.push_back(e);
+    }
+    compact_blocking_spike(interface);
+
+    int received = 0;
+    spike::compact_reader reader(&interface.bytesin_[0],
+        &interface.bytesin_[0] + interface.bytesin_.size());
+    queueing::event e;
+    while(reader.next(e)){
+        BOOST_CHECK_EQUAL(e.t_, 10 + e.data_ % 1000);
+        ++received;
+    }
+    BOOST_CHECK_EQUAL(received, size * (size + 1) / 2);
+    BOOST_CHECK_EQUAL(interface.exchange_stats_, 1);
+    BOOST_CHECK_EQUAL(interface.bytes_received_stats_, interface.bytesin_.size());
+}
+
+/**
+ * tests that every rank reads the spikes of all the ranks in the shared
+ * window after a hierarchical_spike exchange, with one node per machine
+ * and with nodes of 2 ranks, and that the window grows when needed
+ */
+BOOST_AUTO_TEST_CASE(hierarchical_spike_exchange){
+    int size;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Datatype spike = create_spike_type();
+
+    for(int ranks_per_node = 0; ranks_per_node <= 2; ranks_per_node += 2){
+        node_window w = create_node_window(ranks_per_node);
+        //second exchange larger than the initial window
+        int nspikes[2] = {rank + 1, 1000 * (rank + 1)};
+        for(int k = 0; k < 2; ++k){
+            spike::spike_interface interface(size);
+            //rank r sends nspikes[k] spikes, gid = r*100000+i at time 10+i
+            for(int i = 0; i < nspikes[k]; ++i){
+                queueing::event e;
+                e.data_ = rank * 100000 + i;
+                e.t_ = 10 + i;
+                interface.spikeout_.push_back(e);
+            }
+            hierarchical_spike(interface, spike, w);
+
+            int total = 0;
+            MPI_Allreduce(&nspikes[k], &total, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+            BOOST_REQUIRE_EQUAL(interface.nshared_, total);
+            std::vector<int> received(size, 0);
+            for(int i = 0; i < interface.nshared_; ++i){
+                const queueing::event& e = interface.spikein_shared_[i];
+                BOOST_CHECK_EQUAL(e.t_, 10 + e.data_ % 100000);
+                received[e.data_ / 100000]++;
+            }
+            for(int r = 0; r < size; ++r)
+                BOOST_CHECK_EQUAL(received[r], nspikes[k] / (rank + 1) * (r + 1));
+            BOOST_CHECK(w.capacity_ >= total);
+
+            //every spike leaves its node once
+            int type_size;
+            MPI_Type_size(spike, &type_size);
+            double sent = interface.bytes_sent_stats_;
+            MPI_Allreduce(MPI_IN_PLACE, &sent, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+            BOOST_CHECK_EQUAL(sent, static_cast<double>(total) * type_size);
+        }
+        free_node_window(w);
+    }
+    MPI_Type_free(&spike);
+}
+
+/**
+ * tests that targeted_spike delivers the same useful spikes as
+ * blocking_spike: every local gid spikes once, every rank receives
+ * exactly one spike per input presyn and nothing else
+ */
+BOOST_AUTO_TEST_CASE(targeted_spike_exchange){
+    int size;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Datatype spike = create_spike_type();
+
+    //with size > 1, some ranks have one cell more
+    const int ncells = 64 * size + size / 2;
+    environment::continousdistribution neuro_dist(size, rank, ncells);
+    environment::presyn_maker presyns(8);
+    presyns(rank, &neuro_dist);
+    spike_targets t = create_spike_targets(presyns, ncells);
+
+    std::vector<int> outputs, inputs;
+    presyns.output_gids(outputs);
+    presyns.input_gids(inputs);
+
+    spike::spike_interface targeted(size), reference(size);
+    for(int i = 0; i < outputs.size(); ++i){
+        queueing::event e;
+        e.data_ = outputs[i];
+        e.t_ = 10 + i;
+        targeted.spikeout_.push_back(e);
+        reference.spikeout_.push_back(e);
+    }
+    targeted_spike(targeted, spike, t);
+    blocking_spike(reference, spike);
+
+    std::vector<int> received, expected;
+    for(int i = 0; i < targeted.spikein_.size(); ++i){
+        BOOST_CHECK(presyns.find_input(targeted.spikein_[i].data_) != NULL);
+        received.push_back(targeted.spikein_[i].data_);
+    }
+    for(int i = 0; i < reference.spikein_.size(); ++i){
+        if(presyns.find_input(reference.spikein_[i].data_) != NULL)
+            expected.push_back(reference.spikein_[i].data_);
+    }
+    std::sort(received.begin(), received.end());
+    std::sort(expected.begin(), expected.end());
+    BOOST_CHECK(received == expected);
+    BOOST_CHECK(received == inputs);
+    BOOST_CHECK(targeted.bytes_received_stats_ <= reference.bytes_received_stats_);
+
+    MPI_Type_free(&spike);
+}
+
+/**
+ * tests the spike exchange benchmark: the bytes per rank of the allgather
+ * exchange, the order of the percentiles and the csv round trip
+ */
+BOOST_AUTO_TEST_CASE(spike_bench_test){
+    int size;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Datatype spike = create_spike_type();
+    int type_size;
+    MPI_Type_size(spike, &type_size);
+
+    environment::continousdistribution neuro_dist(size, rank, 16 * size);
+    environment::presyn_maker presyns(4);
+    presyns(rank, &neuro_dist);
+    std::vector<int> gids;
+    presyns.output_gids(gids);
+    exchange_context c = create_exchange_context(allgather_exchange, presyns, 16 * size);
+
+    spike::spike_interface d(size);
+    bench_result r = run_bench(d, spike, gids, allgather_exchange, false, 10, 20, 5, c, 1);
+    BOOST_CHECK_EQUAL(r.ranks_, size);
+    BOOST_CHECK_EQUAL(r.reps_, 20);
+    BOOST_CHECK_EQUAL(r.exchange_, "allgather");
+    BOOST_CHECK_EQUAL(r.encoding_, "struct");
+    BOOST_CHECK_CLOSE(r.bytes_sent_, 10. * type_size, 1e-9);
+    BOOST_CHECK_CLOSE(r.bytes_received_, 10. * size * type_size, 1e-9);
+    BOOST_CHECK(r.p50_us_ > 0. && r.p50_us_ <= r.p99_us_);
+    BOOST_CHECK(d.spikeout_.size() == 10 && d.spikein_.empty());
+    BOOST_CHECK(!bench_supported(targeted_exchange, true));
+
+    bench_result p;
+    BOOST_CHECK(!parse_bench_line(bench_csv_header(), p));
+    BOOST_CHECK(parse_bench_line(bench_csv_line(r), p));
+    BOOST_CHECK_EQUAL(p.exchange_, r.exchange_);
+    BOOST_CHECK_EQUAL(p.spikes_, 10);
+    BOOST_CHECK_CLOSE(p.bytes_received_, r.bytes_received_, 1e-3);
+
+    //twice as fast as the baseline
+    std::vector<bench_result> current(1, p), baseline(1, p);
+    baseline[0].p50_us_ = 2. * p.p50_us_;
+    std::stringstream out;
+    BOOST_CHECK_EQUAL(compare_bench(current, baseline, out), 1);
+    BOOST_CHECK(out.str().find(" 2 ") != std::string::npos);
+    baseline[0].encoding_ = "compact";
+    BOOST_CHECK_EQUAL(compare_bench(current, baseline, out), 0);
+
+    free_exchange_context(c);
+    MPI_Type_free(&spike);
+}
+
+/**
+ * tests that exchange_selector measures every candidate, selects the
+ * fastest one on every rank, and evaluates again when the spike rate
+ * changes
+ */
+BOOST_AUTO_TEST_CASE(exchange_selector_test){
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    std::vector<exchange_mode> candidates;
+    candidates.push_back(allgather_exchange);
+    candidates.push_back(compact_exchange);
+    const int probe = 3;
+    exchange_selector selector(candidates, probe, 2., false);
+
+    //compact is faster (on rank 0 only, the slowest rank decides)
+    for(int i = 0; i < 2 * probe; ++i){
+        BOOST_CHECK(selector.probing());
+        BOOST_CHECK_EQUAL(selector.mode(), candidates[i / probe]);
+        const double time = (selector.mode() == compact_exchange || rank > 0) ? 1. : 2.;
+        selector.record(time, 10);
+    }
+    BOOST_CHECK(!selector.probing());
+    BOOST_REQUIRE_EQUAL(selector.decisions().size(), 1);
+    BOOST_CHECK_EQUAL(selector.decisions()[0].first, 2 * probe);
+    BOOST_CHECK_EQUAL(selector.mode(), compact_exchange);
+
+    //same rate, no new evaluation
+    for(int i = 0; i < 2 * probe; ++i)
+        selector.record(1., 12);
+    BOOST_CHECK(!selector.probing());
+
+    //rate x10, new evaluation, allgather is now faster
+    for(int i = 0; i < probe; ++i)
+        selector.record(1., 120);
+    BOOST_CHECK(selector.probing());
+    for(int i = 0; i < 2 * probe; ++i)
+        selector.record(selector.mode() == allgather_exchange ? 1. : 2., 120);
+    BOOST_REQUIRE_EQUAL(selector.decisions().size(), 2);
+    BOOST_CHECK_EQUAL(selector.mode(), allgather_exchange);
+}
+
+/**
+ * presyns stub for create_dist_graph: rank r has an input presyn
+ * for the first gid of the ranks r+1 and r+3 (modulo size), input_gids
+ * lists them in increasing order
+ */
+struct ring_presyns{
+    int rank_, size_, ncells_;
+    const ring_presyns* find_input(int gid) const{
+        const int owner = gid / ncells_;
+        if(gid % ncells_ != 0 || owner == rank_)
+            return NULL;
+        if(owner == (rank_ + 1) % size_ || owner == (rank_ + 3) % size_)
+            return this;
+        return NULL;
+    }
+    void input_gids(std::vector<int>& gids) const{
+        gids.clear();
+        for(int owner = 0; owner < size_; ++owner)
+            if(find_input(owner * ncells_))
+                gids.push_back(owner * ncells_);
+    }
+};
+
+/**
+ * tests that create_dist_graph builds the same neighbors
+ * as the broadcast version create_dist_graph_bcast
+ */
+BOOST_AUTO_TEST_CASE(create_dist_graph_test){
+    int size;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    ring_presyns p = {rank, size, 4};
+    MPI_Comm scalable = create_dist_graph(p, 4);
+    MPI_Comm reference = create_dist_graph_bcast(p, 4);
+
+    int in[2], out[2], weighted[2];
+    MPI_Dist_graph_neighbors_count(scalable, &in[0], &out[0], &weighted[0]);
+    MPI_Dist_graph_neighbors_count(reference, &in[1], &out[1], &weighted[1]);
+    BOOST_REQUIRE_EQUAL(in[0], in[1]);
+    BOOST_REQUIRE_EQUAL(out[0], out[1]);
+
+    std::vector<int> srcs[2], dsts[2];
+    for(int i = 0; i < 2; ++i){
+        srcs[i].resize(in[i] + 1);
+        dsts[i].resize(out[i] + 1);
+    }
+    MPI_Dist_graph_neighbors(scalable, in[0], &srcs[0][0], MPI_UNWEIGHTED,
+                             out[0], &dsts[0][0], MPI_UNWEIGHTED);
+    MPI_Dist_graph_neighbors(reference, in[1], &srcs[1][0], MPI_UNWEIGHTED,
+                             out[1], &dsts[1][0], MPI_UNWEIGHTED);
+    BOOST_CHECK(srcs[0] == srcs[1]);
+    BOOST_CHECK(dsts[0] == dsts[1]);
+
+    MPI_Comm_free(&scalable);
+    MPI_Comm_free(&reference);
+}
+
 /**
  * for queueing::pool and spike::environment
  * test that run sim function results in the expected end state
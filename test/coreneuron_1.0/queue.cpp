@@ -37,6 +37,7 @@
 
 #include "coreneuron_1.0/queue/queue.h"
 #include "coreneuron_1.0/queue/tool/priority_queue.hpp"
+#include "coreneuron_1.0/queue/trace_benchmark.h"
 #include "coreneuron_1.0/common/data/helper.h" // common functionalities
 #include "utils/error.h"
 
@@ -46,7 +47,13 @@ typedef boost::mpl::list<tool::sptq_queue<int,std::greater<int> >,
                          tool::sptq_queue<double,std::greater<double> >,
                          tool::bin_queue<int>,
                          tool::bin_queue<float>,
-                         tool::bin_queue<double> > full_test_types;
+                         tool::bin_queue<double>,
+                         tool::sptq_queue<double,std::greater<double>,
+                                          tool::new_allocator<tool::sptq_node<double> > >,
+                         tool::bin_queue<double,tool::new_allocator<tool::bin_node<double> > >,
+                         tool::calendar_queue<int>,
+                         tool::calendar_queue<float>,
+                         tool::calendar_queue<double> > full_test_types;
 
 
 BOOST_AUTO_TEST_CASE_TEMPLATE(constructor,T,full_test_types) {
@@ -133,7 +140,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(remove_greater,T,full_test_types) {
         it++;
     }
     
-    node_type* n = new node_type(55);
+    node_type* n = queue.create(55);
     queue.push(n);
     BOOST_CHECK_EQUAL(queue.size(), 11);
     BOOST_CHECK_EQUAL(queue.top(), 2);
@@ -142,6 +149,158 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(remove_greater,T,full_test_types) {
     BOOST_CHECK_EQUAL(queue.size(), 11);
   }
 
+BOOST_AUTO_TEST_CASE(node_pool_recycle) {
+    typedef tool::bin_node<double> node_type;
+    tool::node_pool<node_type> pool(16);
+    std::vector<node_type*> v;
+    for(int i=0 ; i < 20; i++)
+        v.push_back(pool.create(i));
+    BOOST_CHECK_EQUAL(pool.capacity(), 32); // two chunks
+    for(int i=0 ; i < 20; i++)
+        BOOST_CHECK_EQUAL(v[i]->t_, i);
+    BOOST_CHECK_EQUAL(v[1] - v[0], 1); // contiguous into a chunk
+
+    pool.destroy(v[7]);
+    pool.destroy(v[3]);
+    node_type* n = pool.create(42.);
+    BOOST_CHECK_EQUAL(n, v[3]); // last released first
+    BOOST_CHECK_EQUAL(n->t_, 42.);
+    BOOST_CHECK_EQUAL(n->left_, (node_type*)0);
+    BOOST_CHECK_EQUAL(pool.create(43.), v[7]);
+    BOOST_CHECK_EQUAL(pool.capacity(), 32);
+
+    BOOST_CHECK(pool.owns(v[19]));
+    node_type foreign(1.);
+    BOOST_CHECK(!pool.owns(&foreign));
+}
+
+BOOST_AUTO_TEST_CASE(pooled_queues_reuse_nodes) {
+    tool::bin_queue<double> bq;
+    tool::sptq_queue<double, std::greater<double> > sq;
+    for(int j=0 ; j < 4; j++){ // the nodes of a round are recycled by the next ones
+        for(int i=0 ; i < 100; i++){
+            bq.push((i*37)%100);
+            sq.push((i*37)%100);
+        }
+        for(int i=0 ; i < 100; i++){
+            BOOST_CHECK_EQUAL(bq.top(), i);
+            BOOST_CHECK_EQUAL(sq.top(), i);
+            bq.pop();
+            sq.pop();
+        }
+    }
+    BOOST_CHECK(bq.empty());
+    BOOST_CHECK(sq.empty());
+}
+
+BOOST_AUTO_TEST_CASE(calendar_queue_overflow) {
+    // small wheel, most of the elements are beyond one year and go to the overflow
+    tool::calendar_queue<double> queue(0.5, 0., 8);
+    std::vector<double> ref;
+    srand(7);
+    for(int i=0 ; i < 200; i++){
+        double t = (rand()%1000)*0.1;
+        queue.push(t);
+        ref.push_back(t);
+    }
+    std::sort(ref.begin(), ref.end());
+
+    // pop the first half, then push behind the cursor, in and beyond the wheel
+    double last(0.);
+    for(int i=0 ; i < 100; i++){
+        BOOST_CHECK_EQUAL(queue.top(), ref[i]);
+        last = queue.top();
+        queue.pop();
+    }
+    ref.erase(ref.begin(), ref.begin()+100);
+    double late[] = {last - 1., last, last + 0.3, last + 2., last + 50.};
+    for(int i=0 ; i < 5; i++){
+        queue.push(late[i]);
+        ref.push_back(late[i]);
+    }
+    std::sort(ref.begin(), ref.end());
+
+    BOOST_CHECK_EQUAL(queue.size(), ref.size());
+    for(std::size_t i=0 ; i < ref.size(); i++){
+        BOOST_CHECK_EQUAL(queue.top(), ref[i]);
+        queue.pop();
+    }
+    BOOST_CHECK(queue.empty());
+}
+
+typedef boost::mpl::list<tool::bin_queue<double>,
+                         tool::bin_queue<double,tool::new_allocator<tool::bin_node<double> > >,
+                         tool::calendar_queue<double> > drain_test_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(drain_until,T,drain_test_types) {
+    T queue;
+    std::vector<double> ref;
+    srand(11);
+    for(int i=0 ; i < 1000; i++){
+        double t = (rand()%4000)*0.025;
+        queue.push(t);
+        ref.push_back(t);
+    }
+    std::sort(ref.begin(), ref.end());
+
+    // bulk pops at growing times, partially due bins included
+    std::vector<double> out;
+    std::size_t first = 0;
+    for(double til = 0.; til < 110.; til += 3.3){
+        std::size_t n = queue.drain_until(til, out);
+        std::size_t last = std::upper_bound(ref.begin(), ref.end(), til) - ref.begin();
+        BOOST_REQUIRE_EQUAL(n, last - first);
+        std::sort(out.end() - n, out.end());
+        BOOST_CHECK(std::equal(out.end() - n, out.end(), ref.begin() + first));
+        BOOST_CHECK_EQUAL(queue.size(), ref.size() - last);
+        first = last;
+    }
+    BOOST_CHECK(queue.empty());
+}
+
+// as helper_type of trait.h, which can not be included twice
+struct trace_bin_queue {
+    typedef tool::bin_queue<double> value_type;
+    const static char name[];
+};
+const char trace_bin_queue::name[] = "bin_queue";
+
+BOOST_AUTO_TEST_CASE(trace_round_trip) {
+    std::vector<queue::trace> traces(2);
+    for(int i=0 ; i < 100; i++){
+        traces[0].insert(i%7 + 3.);
+        traces[1].insert(i%5 + (i%2 ? 1. : 0.25)); // half not integral, raw doubles
+        if(i%10 == 9)
+            for(int k=0 ; k < 20; k++)
+                traces[0].dq(i/10 + 3.); // collapsed
+    }
+    for(int i=0 ; i < 300; i++)
+        traces[1].dq(10.); // more than 255, two records
+    BOOST_CHECK_EQUAL(traces[1].size(), 102);
+    BOOST_CHECK_EQUAL(traces[1].noperations(), 400);
+
+    BOOST_CHECK(queue::write_traces("queue_trace_test.bin", traces));
+    std::vector<queue::trace> read;
+    BOOST_CHECK(queue::read_traces("queue_trace_test.bin", read));
+    BOOST_CHECK_EQUAL(read.size(), 2);
+    for(int i=0 ; i < 2; i++){
+        BOOST_CHECK_EQUAL(read[i].size(), traces[i].size());
+        BOOST_CHECK_EQUAL(read[i].noperations(), traces[i].noperations());
+        queue::trace::const_iterator a = traces[i].begin(), b = read[i].begin();
+        for(; a != traces[i].end(); ++a, ++b)
+            BOOST_CHECK(a->op_ == b->op_ && a->repeat_ == b->repeat_ && a->t_ == b->t_);
+    }
+    BOOST_CHECK(!queue::read_traces("queue_trace_no_file.bin", read));
+
+    // every operation is timed once
+    queue::cycle_histogram insert, dq;
+    queue::trace_helper::replay<trace_bin_queue>(traces, insert, dq);
+    BOOST_CHECK_EQUAL(insert.count(), 200);
+    BOOST_CHECK_EQUAL(dq.count(), traces[0].noperations() + traces[1].noperations() - 200);
+    BOOST_CHECK(dq.quantile(0.5) <= dq.quantile(0.99));
+    std::remove("queue_trace_test.bin");
+}
+
 BOOST_AUTO_TEST_CASE(helper_solver_test){
     std::vector<std::string> command_v;
     int error(mapp::MAPP_OK);
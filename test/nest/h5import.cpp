@@ -319,6 +319,59 @@ BOOST_AUTO_TEST_CASE(nset_h5import_nestnodesynapse)
     BOOST_CHECK_EQUAL( syns.size(), 0 );
 }
 
+/* serialize_sorted writes the entries grouped by node id, in their
+ original order within a node (stable), for any number of threads
+ */
+BOOST_AUTO_TEST_CASE(nest_h5import_serialize_sorted)
+{
+    const size_t num_processes = 5;
+    const size_t n = 1003;
+    h5import::SynapseList syns( 2 );
+    syns.resize( n );
+    for ( size_t i=0; i<n; i++ ) {
+        h5import::SynapseRef s = syns[ i ];
+        s.source_neuron_ = i;
+        s.target_neuron_ = 2*i;
+        s.node_id_ = ( i * 7 + i / 13 ) % ( num_processes - 1 ); // last rank gets nothing
+        s.params_[ 0 ] = 0.5 * i;
+        s.params_[ 1 ] = 1.;
+    }
+    const size_t intsizeof_entry = syns.sizeof_entry() / sizeof( int );
+
+    for ( int nthreads=1; nthreads<=4; nthreads++ ) {
+#ifdef _OPENMP
+        omp_set_num_threads( nthreads );
+#endif
+        h5import::mpi_buffer< int > buf( 0 );
+        std::vector< int > sendcounts;
+        syns.serialize_sorted( buf, sendcounts, num_processes );
+
+        BOOST_REQUIRE_EQUAL( buf.size(), n * intsizeof_entry );
+        BOOST_REQUIRE_EQUAL( sendcounts.size(), num_processes );
+        BOOST_CHECK_EQUAL( sendcounts[ num_processes - 1 ], 0 );
+
+        uint32_t source, node, pool[ 3 ];
+        h5import::SynapseRef s( source, node, 2, reinterpret_cast< char* >( pool ) );
+        size_t e = 0;
+        for ( size_t r=0; r<num_processes; r++ ) {
+            BOOST_REQUIRE_EQUAL( sendcounts[ r ] % intsizeof_entry, 0 );
+            const size_t end = e + sendcounts[ r ] / intsizeof_entry;
+            for ( int last = -1; e<end; e++ ) {
+                s.deserialize( buf, e * intsizeof_entry );
+                BOOST_CHECK_EQUAL( s.node_id_, r );
+                BOOST_CHECK( static_cast< int >( s.source_neuron_ ) > last );
+                BOOST_CHECK_EQUAL( s.target_neuron_, 2 * s.source_neuron_ );
+                BOOST_CHECK_EQUAL( s.params_[ 0 ], 0.5f * s.source_neuron_ );
+                last = s.source_neuron_;
+            }
+        }
+        BOOST_CHECK_EQUAL( e, n );
+    }
+
+    syns.release();
+    BOOST_CHECK_EQUAL( syns.size(), 0 );
+}
+
 BOOST_AUTO_TEST_CASE( nest_h5import_kernel )
 {
     int ncells = 1234;
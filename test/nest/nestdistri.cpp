@@ -28,6 +28,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 
+#include <set>
+
 #include <mpi.h>
 
 #include "utils/error.h"
@@ -35,6 +37,7 @@
 #include "nest/nestkernel/event_passing/mpi_manager.h"
 #include "nest/nestkernel/event_passing/simulationmanager.h"
 #include "nest/nestkernel/event_passing/eventdelivermanager.h"
+#include "nest/nestkernel/event_passing/target_table.h"
 #include "nest/nestkernel/environment/connectionmanager.h"
 
 #include "coreneuron_1.0/event_passing/environment/event_generators.hpp"
@@ -97,6 +100,49 @@ BOOST_AUTO_TEST_CASE(nest_distri_mpi)
 }
 
 
+BOOST_AUTO_TEST_CASE(nest_distri_buffer_sizing)
+{
+    //geometric growth above the level, one shrink step per exchange
+    nest::buffer_sizing sizing(0.5, 2., true);
+    BOOST_CHECK_EQUAL(sizing.next_size(10, 4), 32);
+    BOOST_CHECK_EQUAL(sizing.next_size(0, 32), 16);
+    BOOST_CHECK_EQUAL(sizing.next_size(0, 16), 8);
+    BOOST_CHECK_EQUAL(sizing.next_size(0, 8), 4);
+    BOOST_CHECK_EQUAL(sizing.next_size(0, 4), 4); //min_size
+
+    nest::buffer_sizing no_shrink(0.5, 2., false);
+    BOOST_CHECK_EQUAL(no_shrink.next_size(10, 4), 32);
+    BOOST_CHECK_EQUAL(no_shrink.next_size(0, 32), 32);
+
+    int num_processes;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &num_processes);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    //rank 0 needs 6 entries, the others 3 (last entry of the buffer)
+    int send_buffer_size = 4;
+    int recv_buffer_size = send_buffer_size * num_processes;
+    std::vector< int > displacements(num_processes);
+    std::vector< uint_t > send_buffer(send_buffer_size, 0);
+    std::vector< uint_t > recv_buffer(recv_buffer_size, 0);
+    if (rank == 0)
+        send_buffer.resize(6, 7);
+    else
+        send_buffer[send_buffer_size-1] = 3;
+
+    nest::buffer_sizing predictive;
+    nest::comm_volume volume;
+    nest::mpi_manager::communicate_Allgather(send_buffer, recv_buffer, displacements,
+        send_buffer_size, recv_buffer_size, &volume, &predictive);
+
+    //same size on all ranks: 1.5 times the level 6
+    BOOST_CHECK_EQUAL(send_buffer_size, 9);
+    BOOST_CHECK_EQUAL(recv_buffer_size, 9*num_processes);
+    BOOST_CHECK_EQUAL(volume.overflows, 1);
+    BOOST_CHECK_EQUAL(recv_buffer[5], 7);
+}
+
+
 std::vector<int> getTargets(environment::presyn_maker& presyns, const int& s_gid)
 {
     std::vector<int> outputs;
@@ -258,3 +304,289 @@ BOOST_AUTO_TEST_CASE(nest_distri_event)
 
 
 
+BOOST_AUTO_TEST_CASE(nest_distri_target_table)
+{
+    int ncells = 20;
+    int mindelay = 10;
+    int nthreads = 1;
+    int outgoing = 3;
+    int simtime = 5*mindelay;
+
+    int num_processes;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &num_processes);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    namespace po = boost::program_options;
+    po::variables_map vm;
+    vm.insert(std::make_pair("nNeurons", po::variable_value(ncells, false)));
+    vm.insert(std::make_pair("nThreads", po::variable_value(nthreads, false)));
+
+    vm.insert(std::make_pair("model", po::variable_value(std::string("tsodyks2"), false)));
+    vm.insert(std::make_pair("delay", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("weight", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("U", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("u", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("x", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("tau_rec", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("tau_fac", po::variable_value(1.0, false)));
+
+    nest::pool_env penv(nthreads);
+
+    std::vector<nest::spikedetector> detectors(ncells);
+    std::vector<nest::targetindex> detectors_targetindex(ncells);
+    for(unsigned int i=0; i < detectors.size(); ++i)
+        detectors_targetindex[i] = nest::scheduler::add_node(&detectors[i]);
+
+    environment::continousdistribution neuro_dist(num_processes, rank, ncells);
+    environment::presyn_maker presyns(outgoing, environment::fixedoutdegree);
+    presyns(rank, &neuro_dist);
+
+    nest::connectionmanager cn(vm);
+    for (unsigned int thrd=0; thrd<nthreads; thrd++) {
+        environment::continousdistribution neuro_vp_dist(nthreads, thrd, &neuro_dist);
+        nest::build_connections_from_neuron(thrd, neuro_vp_dist, presyns, detectors_targetindex, cn);
+    }
+
+    nest::target_table targets;
+    targets.build(neuro_dist, presyns);
+
+    //every (source, rank) pair is requested once by the rank of the targets
+    std::vector<int> inputs;
+    presyns.input_gids(inputs);
+    int pairs = 0;
+    for (unsigned int i=0; i<inputs.size(); i++)
+        pairs += presyns.find_input(inputs[i])->size() > 0;
+    for (unsigned int lid=0; lid<neuro_dist.getlocalcells(); lid++) {
+        const environment::presyn* ps = presyns.find_output(neuro_dist.local2global(lid));
+        pairs += ps != NULL && ps->size() > 0;
+        //target ranks are sorted and unique
+        const size_t gid = neuro_dist.local2global(lid);
+        for (const int* r = targets.begin(gid); r != targets.end(gid); r++) {
+            BOOST_CHECK(*r >= 0 && *r < num_processes);
+            if (r != targets.begin(gid))
+                BOOST_CHECK(*(r-1) < *r);
+        }
+    }
+    int all_pairs, all_size;
+    int size = targets.size();
+    MPI_Allreduce(&pairs, &all_pairs, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&size, &all_size, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    BOOST_CHECK_EQUAL(all_size, all_pairs);
+
+    //the spikes sent to the target ranks only reach all the targets
+    nest::eventdelivermanager edm(cn, num_processes, nthreads, mindelay);
+    edm.use_target_table(targets);
+
+    environment::event_generator generator(nthreads);
+    environment::generate_uniform_events(generator.begin(), simtime, nthreads, 1, &neuro_dist);
+    nest::simulationmanager sm(edm, generator, rank, num_processes, nthreads);
+
+    int events=0;
+    for (unsigned int i=0; i<nthreads; i++)
+        events += generator.get_size(i);
+    for (unsigned int i=0; i<nthreads; i++)
+        sm.update(i, 0, 0, mindelay);
+    edm.gather_events();
+    for (unsigned int i=0; i<nthreads; i++)
+        edm.deliver_events(i, mindelay);
+    for (unsigned int i=0; i<nthreads; i++)
+        events -= generator.get_size(i);
+
+    int spikes = 0;
+    for(unsigned int i=0; i < detectors.size(); ++i)
+        spikes += detectors[i].spikes.size();
+
+    int all_spikes, all_events;
+    MPI_Allreduce(&spikes, &all_spikes, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&events, &all_events, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    BOOST_CHECK_EQUAL(all_spikes, all_events*outgoing);
+    BOOST_CHECK_EQUAL(edm.get_comm_volume().exchanges, 1);
+}
+
+BOOST_AUTO_TEST_CASE(nest_distri_spike_register)
+{
+    //segments grow beyond their capacity, slices are copied in lag order
+    nest::spike_register reg(3, 2);
+    for (uint_t gid=0; gid<5; gid++)
+        reg.push_back(1, gid);
+    reg.push_back(2, 7);
+    reg.push_back(0, 9);
+    BOOST_CHECK_EQUAL(reg.size(), 7);
+    BOOST_CHECK_EQUAL(reg.size(1), 5);
+
+    std::vector<uint_t> buffer(10, 0);
+    uint_t* end = reg.collocate(&buffer[0], 99);
+    BOOST_CHECK_EQUAL(end - &buffer[0], 10);
+    const uint_t expected[10] = {9, 99, 0, 1, 2, 3, 4, 99, 7, 99};
+    for (int i=0; i<10; i++)
+        BOOST_CHECK_EQUAL(buffer[i], expected[i]);
+
+    reg.clear();
+    BOOST_CHECK_EQUAL(reg.size(), 0);
+
+    //the threads copy their sections in parallel
+    int ncells = 20;
+    int mindelay = 10;
+    int nthreads = 3;
+    int outgoing = 3;
+    int simtime = 5*mindelay;
+
+    int num_processes;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &num_processes);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    namespace po = boost::program_options;
+    po::variables_map vm;
+    vm.insert(std::make_pair("nNeurons", po::variable_value(ncells, false)));
+    vm.insert(std::make_pair("nThreads", po::variable_value(nthreads, false)));
+
+    vm.insert(std::make_pair("model", po::variable_value(std::string("tsodyks2"), false)));
+    vm.insert(std::make_pair("delay", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("weight", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("U", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("u", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("x", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("tau_rec", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("tau_fac", po::variable_value(1.0, false)));
+
+    nest::pool_env penv(nthreads);
+
+    std::vector<nest::spikedetector> detectors(ncells);
+    std::vector<nest::targetindex> detectors_targetindex(ncells);
+    for(unsigned int i=0; i < detectors.size(); ++i)
+        detectors_targetindex[i] = nest::scheduler::add_node(&detectors[i]);
+
+    environment::continousdistribution neuro_dist(num_processes, rank, ncells);
+    environment::presyn_maker presyns(outgoing, environment::fixedoutdegree);
+    presyns(rank, &neuro_dist);
+
+    nest::connectionmanager cn(vm);
+    for (unsigned int thrd=0; thrd<nthreads; thrd++) {
+        environment::continousdistribution neuro_vp_dist(nthreads, thrd, &neuro_dist);
+        nest::build_connections_from_neuron(thrd, neuro_vp_dist, presyns, detectors_targetindex, cn);
+    }
+
+    nest::eventdelivermanager edm(cn, num_processes, nthreads, mindelay);
+    environment::event_generator generator(nthreads);
+    environment::generate_uniform_events(generator.begin(), simtime, nthreads, 1, &neuro_dist);
+    nest::simulationmanager sm(edm, generator, rank, num_processes, nthreads);
+
+    int events=0;
+    for (unsigned int i=0; i<nthreads; i++)
+        events += generator.get_size(i);
+
+    #pragma omp parallel num_threads(nthreads)
+    {
+        const int thrd = omp_get_thread_num();
+        sm.update(thrd, 0, 0, mindelay);
+        #pragma omp barrier
+        edm.collocate_events(thrd);
+        #pragma omp master
+        edm.gather_events();
+    }
+    //a thread delivers to its own targets only
+    for (unsigned int i=0; i<nthreads; i++)
+        edm.deliver_events(i, mindelay);
+    for (unsigned int i=0; i<nthreads; i++)
+        events -= generator.get_size(i);
+
+    int spikes = 0;
+    for(unsigned int i=0; i < detectors.size(); ++i)
+        spikes += detectors[i].spikes.size();
+
+    int all_spikes, all_events;
+    MPI_Allreduce(&spikes, &all_spikes, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&events, &all_events, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    BOOST_CHECK_EQUAL(all_spikes, all_events*outgoing);
+}
+
+BOOST_AUTO_TEST_CASE(nest_distri_sorted_delivery)
+{
+    int ncells = 20;
+    int mindelay = 10;
+    int nthreads = 2;
+    int outgoing = 3;
+    int simtime = 5*mindelay;
+
+    int num_processes;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &num_processes);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    namespace po = boost::program_options;
+    po::variables_map vm;
+    vm.insert(std::make_pair("nNeurons", po::variable_value(ncells, false)));
+    vm.insert(std::make_pair("nThreads", po::variable_value(nthreads, false)));
+
+    vm.insert(std::make_pair("model", po::variable_value(std::string("tsodyks2"), false)));
+    vm.insert(std::make_pair("delay", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("weight", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("U", po::variable_value(0.5, false)));
+    vm.insert(std::make_pair("u", po::variable_value(0.5, false)));
+    vm.insert(std::make_pair("x", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("tau_rec", po::variable_value(10.0, false)));
+    vm.insert(std::make_pair("tau_fac", po::variable_value(10.0, false)));
+
+    nest::pool_env penv(nthreads);
+
+    environment::continousdistribution neuro_dist(num_processes, rank, ncells);
+    environment::presyn_maker presyns(outgoing, environment::fixedoutdegree);
+    presyns(rank, &neuro_dist);
+
+    //received (sender, time, weight) of every detector, buffer order then sorted
+    std::vector< std::vector< std::vector<double> > > received(2);
+    for (int sorted=0; sorted<2; sorted++) {
+        std::vector<nest::spikedetector> detectors(ncells);
+        std::vector<nest::targetindex> detectors_targetindex(ncells);
+        for(unsigned int i=0; i < detectors.size(); ++i)
+            detectors_targetindex[i] = nest::scheduler::add_node(&detectors[i]);
+
+        nest::connectionmanager cn(vm);
+        for (unsigned int thrd=0; thrd<nthreads; thrd++) {
+            environment::continousdistribution neuro_vp_dist(nthreads, thrd, &neuro_dist);
+            nest::build_connections_from_neuron(thrd, neuro_vp_dist, presyns, detectors_targetindex, cn);
+        }
+
+        nest::eventdelivermanager edm(cn, num_processes, nthreads, mindelay);
+        if (sorted)
+            edm.use_sorted_delivery();
+        environment::event_generator generator(nthreads);
+        environment::generate_uniform_events(generator.begin(), simtime, nthreads, 1, &neuro_dist);
+        nest::simulationmanager sm(edm, generator, rank, num_processes, nthreads);
+
+        for (int t=0; t<simtime; t+=mindelay) {
+            if (t>0)
+                for (unsigned int i=0; i<nthreads; i++)
+                    edm.deliver_events(i, t);
+            for (unsigned int i=0; i<nthreads; i++)
+                sm.update(i, t, 0, mindelay);
+            edm.gather_events();
+        }
+
+        received[sorted].resize(ncells);
+        for (unsigned int i=0; i<detectors.size(); i++) {
+            std::vector<double>& r = received[sorted][i];
+            for (unsigned int k=0; k<detectors[i].spikes.size(); k++) {
+                r.push_back(detectors[i].spikes[k].get_sender_gid());
+                r.push_back(detectors[i].spikes[k].get_stamp().get_ms());
+                r.push_back(detectors[i].spikes[k].get_weight());
+            }
+        }
+    }
+
+    //the spikes of a source keep their order: same weights
+    int nspikes = 0;
+    for (int i=0; i<ncells; i++) {
+        nspikes += received[0][i].size() / 3;
+        BOOST_REQUIRE_EQUAL(received[0][i].size(), received[1][i].size());
+        std::multiset< std::vector<double> > order, sorted;
+        for (unsigned int k=0; k<received[0][i].size(); k+=3) {
+            order.insert(std::vector<double>(received[0][i].begin()+k, received[0][i].begin()+k+3));
+            sorted.insert(std::vector<double>(received[1][i].begin()+k, received[1][i].begin()+k+3));
+        }
+        BOOST_CHECK(order == sorted);
+    }
+    BOOST_CHECK(nspikes > 0);
+}
@@ -25,6 +25,7 @@
 
 #define BOOST_TEST_MODULE PoolTest
 #include <iostream>
+#include <vector>
 #include <boost/test/unit_test.hpp>
 #include <boost/filesystem.hpp>
 
@@ -61,3 +62,74 @@ BOOST_AUTO_TEST_CASE(nest_pool_allocate)
     }
 
 }
+
+BOOST_AUTO_TEST_CASE(nest_slab_allocate)
+{
+    nest::SlabAllocator s;
+    //same size class: 16 bytes granularity
+    void* a = s.alloc(40);
+    void* b = s.alloc(48);
+    BOOST_CHECK_EQUAL(static_cast<char*>(b) - static_cast<char*>(a), 48);
+    BOOST_CHECK_EQUAL(s.stats().live_bytes, 96);
+    BOOST_CHECK_EQUAL(s.stats().slab_bytes, nest::SlabAllocator::slab_size);
+
+    //other size class, other slab
+    void* c = s.alloc(100);
+    BOOST_CHECK_EQUAL(s.stats().slab_bytes, 2*nest::SlabAllocator::slab_size);
+
+    //freed block reused by the same size class
+    s.dealloc(a);
+    void* d = s.alloc(33);
+    BOOST_CHECK_EQUAL(d, a);
+    BOOST_CHECK_EQUAL(s.stats().nreused, 1);
+
+    //an empty slab is taken by any size class
+    s.dealloc(c);
+    void* e = s.alloc(500);
+    BOOST_CHECK_EQUAL(s.stats().nslabs_reused, 1);
+    BOOST_CHECK_EQUAL(s.stats().slab_bytes, 2*nest::SlabAllocator::slab_size);
+    BOOST_CHECK_EQUAL(s.stats().live_bytes, 96 + 512);
+    BOOST_CHECK(s.stats().fragmentation() > 0.99);
+
+    BOOST_CHECK_THROW(s.alloc(nest::SlabAllocator::max_object_size + 1), std::bad_alloc);
+
+    s.dealloc(b);
+    s.dealloc(d);
+    s.dealloc(e);
+    BOOST_CHECK_EQUAL(s.stats().live_bytes, 0);
+    BOOST_CHECK_EQUAL(s.stats().peak_live_bytes, 96 + 512);
+    s.release();
+    BOOST_CHECK_EQUAL(s.stats().slab_bytes, 0);
+}
+
+BOOST_AUTO_TEST_CASE(nest_slab_fill)
+{
+    nest::SlabAllocator s;
+    //more blocks than a slab holds, then free all of them
+    const int n = 3 * nest::SlabAllocator::slab_size / 64;
+    std::vector<void*> p(n);
+    for (int i = 0; i < n; i++)
+        p[i] = s.alloc(64);
+    BOOST_CHECK_EQUAL(s.stats().slab_bytes, 4*nest::SlabAllocator::slab_size);
+    for (int i = 0; i < n; i++)
+        s.dealloc(p[i]);
+    BOOST_CHECK_EQUAL(s.stats().live_bytes, 0);
+    //the empty slabs are reused before new ones are taken from the OS
+    for (int i = 0; i < n; i++)
+        p[i] = s.alloc(128);
+    BOOST_CHECK_EQUAL(s.stats().nslabs_reused, 4);
+    BOOST_CHECK_EQUAL(s.stats().slab_bytes, 7*nest::SlabAllocator::slab_size);
+    s.release();
+}
+
+BOOST_AUTO_TEST_CASE(nest_pool_slab)
+{
+    nest::PoorMansAllocator p;
+    p.slab = true;
+    p.init();
+    void* a = p.alloc(64);
+    p.dealloc(a);
+    BOOST_CHECK_EQUAL(p.alloc(64), a);
+    BOOST_CHECK_EQUAL(p.stats().nallocs, 2);
+    p.destruct();
+}
@@ -31,6 +31,7 @@
 
 #include "nest/models/tsodyks2.h"
 #include "nest/nestkernel/environment/connector_base.h"
+#include "nest/nestkernel/environment/soa_connector.h"
 #include "nest/nestkernel/environment/connectionmanager.h"
 #include "nest/nestkernel/environment/event.h"
 #include "nest/nestkernel/environment/scheduler.h"
@@ -351,6 +352,98 @@ BOOST_AUTO_TEST_CASE(nest_connector_send) {
     }
 }
 
+/* The SoA connector delivers the same weights as the connector of tsodyks2
+ objects, with shared and with per synapse time constants.
+ */
+BOOST_AUTO_TEST_CASE(nest_soa_connector_send) {
+    nest::pool_env pevn;
+    nest::scheduler test_env;
+
+    const unsigned int k = K_CUTOFF + 5;
+    for (int shared = 0; shared < 2; shared++) {
+        std::vector<nest::spikedetector> aos_detector(k);
+        std::vector<nest::spikedetector> soa_detector(k);
+        ConnectorBase* aos = NULL;
+        ConnectorBase* soa = NULL;
+
+        for (unsigned int i=0; i<k; i++) {
+            const double tau_rec = shared ? 800. : 100. + 50. * i;
+            const double tau_fac = shared ? 0. : 10. * (i % 3);
+            const double U = 0.1 + 0.05 * i;
+            nest::tsodyks2 aos_synapse(1, 1. + i, U, 0.5, 1., tau_rec, tau_fac, nest::scheduler::add_node(&(aos_detector[i])));
+            nest::tsodyks2 soa_synapse(1, 1. + i, U, 0.5, 1., tau_rec, tau_fac, nest::scheduler::add_node(&(soa_detector[i])));
+            aos = nest::add_connection< tsodyks2 >(aos, aos_synapse);
+            soa = nest::add_soa_connection(soa, soa_synapse);
+        }
+        BOOST_REQUIRE_EQUAL(soa->get_size(), k);
+        BOOST_CHECK_EQUAL(static_cast<nest::SoAConnector*>(soa)->shared_tau(), shared == 1);
+
+        for (unsigned int i=0; i<5; i++) {
+            nest::spikeevent se;
+            se.set_stamp( 3.*(i+1) );
+            aos->send( se );
+            soa->send( se );
+        }
+        for (unsigned int j=0; j<k; j++) {
+            BOOST_REQUIRE_EQUAL(soa_detector[j].spikes.size(), 5);
+            for (unsigned int i=0; i<5; i++)
+                BOOST_CHECK_CLOSE(soa_detector[j].spikes[i].get_weight(), aos_detector[j].spikes[i].get_weight(), 1e-10);
+        }
+        const nest::tsodyks2 last = static_cast<nest::SoAConnector*>(soa)->get(k-1);
+        BOOST_CHECK_EQUAL(last.weight(), static_cast<double>(k));
+        BOOST_CHECK(last.x() < 1.);
+    }
+}
+
+/* Sending through direct targets (no virtual handle) delivers the same
+ weights as the virtual send, for the Connector sizes and the SoA connector.
+ */
+BOOST_AUTO_TEST_CASE(nest_connector_send_direct) {
+    nest::pool_env pevn;
+    nest::scheduler test_env;
+
+    const unsigned int sizes[3] = {1, 3, K_CUTOFF + 5};
+    for (int soa = 0; soa < 2; soa++)
+    for (int s = 0; s < 3; s++) {
+        const unsigned int k = sizes[s];
+        std::vector<nest::spikedetector> detector(k);
+        std::vector<nest::spikedetector> direct_detector(k);
+        std::vector<nest::targetindex> direct_index(k);
+        for (unsigned int i=0; i<k; i++)
+            direct_index[i] = nest::scheduler::add_node(&(direct_detector[i]));
+        const nest::direct_target<nest::spikedetector> targets(direct_detector, direct_index);
+
+        ConnectorBase* conn = NULL;
+        ConnectorBase* direct = NULL;
+        for (unsigned int i=0; i<k; i++) {
+            const double U = 0.1 + 0.05 * i;
+            nest::tsodyks2 synapse(1, 1. + i, U, 0.5, 1., 100., 10., nest::scheduler::add_node(&(detector[i])));
+            nest::tsodyks2 direct_synapse(1, 1. + i, U, 0.5, 1., 100., 10., direct_index[i]);
+            if (soa) {
+                conn = nest::add_soa_connection(conn, synapse);
+                direct = nest::add_soa_connection(direct, direct_synapse);
+            }
+            else {
+                conn = nest::add_connection< tsodyks2 >(conn, synapse);
+                direct = nest::add_connection< tsodyks2 >(direct, direct_synapse);
+            }
+        }
+
+        for (unsigned int i=0; i<5; i++) {
+            nest::spikeevent se;
+            se.set_stamp( 3.*(i+1) );
+            conn->send( se );
+            direct->send( se, targets );
+        }
+        for (unsigned int j=0; j<k; j++) {
+            BOOST_REQUIRE_EQUAL(direct_detector[j].spikes.size(), 5);
+            for (unsigned int i=0; i<5; i++)
+                BOOST_CHECK_EQUAL(direct_detector[j].spikes[i].get_weight(), detector[j].spikes[i].get_weight());
+        }
+        BOOST_CHECK_EQUAL(direct->get_t_lastspike(), conn->get_t_lastspike());
+    }
+}
+
 BOOST_AUTO_TEST_CASE(nest_manager_) {
     nest::pool_env pevn;
 
@@ -384,6 +477,17 @@ BOOST_AUTO_TEST_CASE(nest_manager_) {
     cm.send(t, s_gid, se);
 
     BOOST_REQUIRE_EQUAL(sd.spikes.size(), 3);
+
+    //same with structure of arrays connectors
+    vm.insert(std::make_pair("soa", po::variable_value()));
+    nest::connectionmanager soa_cm(vm);
+    nest::spikedetector soa_sd;
+    soa_cm.connect(t, s_gid, nest::scheduler::add_node(&soa_sd));
+    soa_cm.connect(t, s_gid, nest::scheduler::add_node(&soa_sd));
+    soa_cm.connect(t, s_gid, nest::scheduler::add_node(&soa_sd));
+    BOOST_CHECK(dynamic_cast<nest::SoAConnector*>(soa_cm.connections_[ t ].get( s_gid )) != NULL);
+    soa_cm.send(t, s_gid, se);
+    BOOST_REQUIRE_EQUAL(soa_sd.spikes.size(), 3);
 }
 
 BOOST_AUTO_TEST_CASE(nest_manager_build_from_neuron) {
@@ -441,3 +545,154 @@ BOOST_AUTO_TEST_CASE(nest_manager_build_from_neuron) {
 
 
 
+
+BOOST_AUTO_TEST_CASE(nest_manager_freeze) {
+    nest::scheduler test_env;
+
+    nest::pool_env pevn;
+
+    const int ncells = 30;
+    const int outgoing = 12;
+    namespace po = boost::program_options;
+
+    po::variables_map vm;
+    vm.insert(std::make_pair("nNeurons", po::variable_value(ncells, false)));
+    vm.insert(std::make_pair("nThreads", po::variable_value(1, false)));
+
+    vm.insert(std::make_pair("model", po::variable_value(std::string("tsodyks2"), false)));
+    vm.insert(std::make_pair("delay", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("weight", po::variable_value(2.0, false)));
+    vm.insert(std::make_pair("U", po::variable_value(0.5, false)));
+    vm.insert(std::make_pair("u", po::variable_value(0.5, false)));
+    vm.insert(std::make_pair("x", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("tau_rec", po::variable_value(100.0, false)));
+    vm.insert(std::make_pair("tau_fac", po::variable_value(10.0, false)));
+
+    nest::spikedetector detector, frozen_detector;
+    std::vector<nest::targetindex> detectors_targetindex(1, nest::scheduler::add_node(&detector));
+    std::vector<nest::targetindex> frozen_targetindex(1, nest::scheduler::add_node(&frozen_detector));
+
+    environment::continousdistribution neuro_dist(1, 0, ncells);
+    environment::presyn_maker presyns(outgoing, environment::fixedoutdegree);
+    presyns(0, &neuro_dist);
+
+    nest::connectionmanager cm(vm);
+    nest::connectionmanager frozen_cm(vm);
+    build_connections_from_neuron(0, neuro_dist, presyns, detectors_targetindex, cm);
+    build_connections_from_neuron(0, neuro_dist, presyns, frozen_targetindex, frozen_cm);
+
+    //spikes before the freeze, the last spike times are kept
+    nest::spikeevent se;
+    for (int i=0; i<ncells; i+=3) {
+        se.set_stamp( nest::Time(1. + i) );
+        cm.send(0, i, se);
+        frozen_cm.send(0, i, se);
+    }
+
+    const size_t nconnections = frozen_cm.num_connections(0);
+    BOOST_REQUIRE_EQUAL(nconnections, ncells*outgoing);
+    BOOST_CHECK(frozen_cm.memory(0) > 0);
+    frozen_cm.freeze(0);
+    BOOST_CHECK_EQUAL(frozen_cm.num_connections(0), nconnections);
+    BOOST_CHECK_EQUAL(frozen_cm.connections_[ 0 ].size(), 0);
+    BOOST_CHECK_EQUAL(frozen_cm.frozen_tables_[ 0 ].get_size(5), outgoing);
+    BOOST_CHECK_EQUAL(frozen_cm.memory(0), frozen_cm.frozen_tables_[ 0 ].memory());
+    BOOST_CHECK_THROW(frozen_cm.connect(0, 0, frozen_targetindex[0]), std::logic_error);
+
+    for (int i=0; i<ncells; i++) {
+        se.set_stamp( nest::Time(50. + i) );
+        cm.send(0, i, se);
+        frozen_cm.send(0, i, se);
+    }
+    //unknown source
+    frozen_cm.send(0, ncells + 10, se);
+
+    BOOST_REQUIRE_EQUAL(frozen_detector.spikes.size(), detector.spikes.size());
+    for (size_t i=0; i<detector.spikes.size(); i++)
+        BOOST_CHECK_CLOSE(frozen_detector.spikes[i].get_weight(), detector.spikes[i].get_weight(), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(nest_manager_build_inverted) {
+    nest::scheduler test_env;
+
+    const int nthreads = 3;
+    nest::pool_env pevn(nthreads);
+
+    const int ncells = 40;
+    const int outgoing = 7;
+    namespace po = boost::program_options;
+
+    po::variables_map vm;
+    vm.insert(std::make_pair("nNeurons", po::variable_value(ncells, false)));
+    vm.insert(std::make_pair("nThreads", po::variable_value(nthreads, false)));
+
+    vm.insert(std::make_pair("model", po::variable_value(std::string("tsodyks2"), false)));
+    vm.insert(std::make_pair("delay", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("weight", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("U", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("u", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("x", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("tau_rec", po::variable_value(1.0, false)));
+    vm.insert(std::make_pair("tau_fac", po::variable_value(1.0, false)));
+
+    std::vector<nest::spikedetector> detectors(ncells);
+    std::vector<nest::targetindex> detectors_targetindex(ncells);
+    for(unsigned int i=0; i < detectors.size(); ++i)
+        detectors_targetindex[i] = nest::scheduler::add_node(&detectors[i]);
+
+    //two ranks, rank 1 builds its connections
+    environment::continousdistribution neuro_dist(2, 1, ncells);
+    environment::presyn_maker presyns(outgoing, environment::fixedoutdegree);
+    presyns(1, &neuro_dist);
+
+    nest::connectionmanager cm(vm);
+    for (int thrd=0; thrd<nthreads; thrd++) {
+        environment::continousdistribution neuro_vp_dist(nthreads, thrd, &neuro_dist);
+        build_connections_from_neuron(thrd, neuro_vp_dist, presyns, detectors_targetindex, cm);
+    }
+
+    nest::connectionmanager inverted_cm(vm);
+    build_connections_inverted(neuro_dist, presyns, detectors_targetindex, inverted_cm);
+
+    size_t nconnections = 0;
+    for (int thrd=0; thrd<nthreads; thrd++) {
+        BOOST_REQUIRE_EQUAL(inverted_cm.num_connections(thrd), cm.num_connections(thrd));
+        nconnections += cm.num_connections(thrd);
+        for (size_t s=0; s<cm.connections_[ thrd ].size(); s++) {
+            if (!cm.connections_[ thrd ].test( s ))
+                continue;
+            typedef nest::vector_like<nest::tsodyks2> connector;
+            const connector* c = static_cast<const connector*>(cm.connections_[ thrd ].get( s ));
+            const connector* ic = static_cast<const connector*>(inverted_cm.connections_[ thrd ].get( s ));
+            BOOST_REQUIRE(ic != NULL);
+            BOOST_REQUIRE_EQUAL(ic->get_size(), c->get_size());
+            for (size_t i=0; i<c->get_size(); i++)
+                BOOST_CHECK_EQUAL(ic->get( i ).target_, c->get( i ).target_);
+        }
+    }
+    BOOST_CHECK(nconnections > 0);
+}
+
+BOOST_AUTO_TEST_CASE(nest_connector_slab) {
+    nest::pool_env pevn(1, false, true);
+    nest::scheduler test_env;
+
+    nest::spikedetector detector;
+    ConnectorBase* conn = NULL;
+    const unsigned int k = K_CUTOFF + 3;
+    for (unsigned int i=0; i<k; i++) {
+        nest::tsodyks2 synapse(1, 1., 0.5, 0.5, 1., 800., 0., nest::scheduler::add_node(&detector));
+        conn = nest::add_connection< tsodyks2 >(conn, synapse);
+    }
+    BOOST_REQUIRE_EQUAL(conn->get_size(), k);
+
+    //the replaced connectors are given back to the allocator
+    const nest::slab_stats& st = nest::poormansallocpool[0].stats();
+    BOOST_CHECK_EQUAL(st.nallocs, K_CUTOFF);
+    BOOST_CHECK_EQUAL(st.nfrees, K_CUTOFF - 1);
+    BOOST_CHECK(st.live_bytes >= sizeof(nest::Connector< K_CUTOFF, tsodyks2 >));
+
+    nest::spikeevent se;
+    conn->send(se);
+    BOOST_CHECK_EQUAL(detector.spikes.size(), k);
+}